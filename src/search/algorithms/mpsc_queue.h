@@ -0,0 +1,73 @@
+#ifndef ALGORITHMS_MPSC_QUEUE_H
+#define ALGORITHMS_MPSC_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace mpsc_queue {
+/*
+  Lock-free queue for multiple producers and a single consumer.
+
+  Producers push elements onto an intrusive stack with a compare-and-swap
+  loop. The consumer takes out all elements at once with a single atomic
+  exchange and receives them in the order in which they were pushed. This
+  fits message passing between threads where the consumer periodically
+  processes all of its pending messages.
+*/
+template<typename T>
+class MPSCQueue {
+    struct Node {
+        T value;
+        Node *next;
+    };
+
+    std::atomic<Node *> head;
+
+public:
+    MPSCQueue()
+        : head(nullptr) {
+    }
+
+    MPSCQueue(const MPSCQueue &) = delete;
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+    ~MPSCQueue() {
+        Node *node = head.load(std::memory_order_acquire);
+        while (node) {
+            Node *next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    // Can be called by any thread.
+    void push(T &&value) {
+        Node *node = new Node{std::move(value), head.load(std::memory_order_relaxed)};
+        while (!head.compare_exchange_weak(
+                   node->next, node,
+                   std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == nullptr;
+    }
+
+    // Must only be called by the consumer thread.
+    std::vector<T> pop_all() {
+        Node *node = head.exchange(nullptr, std::memory_order_acquire);
+        std::vector<T> values;
+        while (node) {
+            values.push_back(std::move(node->value));
+            Node *next = node->next;
+            delete node;
+            node = next;
+        }
+        std::reverse(values.begin(), values.end());
+        return values;
+    }
+};
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "partial_state_tree.h"
 
 #include "../utils/memory.h"
+#include "../utils/serialization.h"
 
 using namespace std;
 
@@ -137,6 +138,50 @@ int PartialStateTreeNode::get_num_nodes() const {
     return num_nodes;
 }
 
+void PartialStateTreeNode::save(ostream &os) const {
+    utils::write_binary(os, var_id);
+    if (var_id == DEAD_END_LEAF || var_id == REGULAR_LEAF) {
+        return;
+    }
+    utils::write_binary<int>(os, value_successors->size());
+    for (const unique_ptr<PartialStateTreeNode> &successor : *value_successors) {
+        utils::write_binary<bool>(os, successor != nullptr);
+        if (successor) {
+            successor->save(os);
+        }
+    }
+    utils::write_binary<bool>(os, ignore_successor != nullptr);
+    if (ignore_successor) {
+        ignore_successor->save(os);
+    }
+}
+
+void PartialStateTreeNode::load(istream &is) {
+    var_id = utils::read_binary<int>(is);
+    value_successors = nullptr;
+    ignore_successor = nullptr;
+    if (!is || var_id == DEAD_END_LEAF || var_id == REGULAR_LEAF) {
+        return;
+    }
+    int domain_size = utils::read_binary<int>(is);
+    if (!is || domain_size < 0) {
+        is.setstate(ios::failbit);
+        return;
+    }
+    value_successors = utils::make_unique_ptr<vector<unique_ptr<PartialStateTreeNode>>>();
+    value_successors->resize(domain_size);
+    for (unique_ptr<PartialStateTreeNode> &successor : *value_successors) {
+        if (utils::read_binary<bool>(is) && is) {
+            successor = utils::make_unique_ptr<PartialStateTreeNode>();
+            successor->load(is);
+        }
+    }
+    if (utils::read_binary<bool>(is) && is) {
+        ignore_successor = utils::make_unique_ptr<PartialStateTreeNode>();
+        ignore_successor->load(is);
+    }
+}
+
 
 PartialStateTree::PartialStateTree()
     : num_partial_states(0) {
@@ -168,4 +213,14 @@ int PartialStateTree::size() {
 int PartialStateTree::get_num_nodes() const {
     return root.get_num_nodes();
 }
+
+void PartialStateTree::save(ostream &os) const {
+    utils::write_binary(os, num_partial_states);
+    root.save(os);
+}
+
+void PartialStateTree::load(istream &is) {
+    num_partial_states = utils::read_binary<int>(is);
+    root.load(is);
+}
 }
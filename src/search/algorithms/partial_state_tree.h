@@ -3,6 +3,9 @@
 
 #include "../task_proxy.h"
 
+#include <istream>
+#include <ostream>
+
 namespace partial_state_tree {
 class PartialStateTreeNode {
     int var_id;
@@ -19,6 +22,9 @@ public:
     bool contains(const State &state) const;
 
     int get_num_nodes() const;
+
+    void save(std::ostream &os) const;
+    void load(std::istream &is);
 };
 
 class PartialStateTree {
@@ -34,6 +40,10 @@ public:
     bool subsumes(const State &state) const;
     int size();
     int get_num_nodes() const;
+
+    // Write the tree to a binary stream and read it back.
+    void save(std::ostream &os) const;
+    void load(std::istream &is);
 };
 }
 
@@ -36,6 +36,8 @@ static vector<CartesianHeuristicFunction> generate_heuristic_functions(
         opts.get<PickSplit>("tiebreak_split"),
         opts.get<int>("max_concrete_states_per_abstract_state"),
         opts.get<int>("max_state_expansions"),
+        opts.get<int>("flaw_search_threads"),
+        opts.get<bool>("store_loops"),
         opts.get<int>("memory_padding"),
         *rng,
         log,
@@ -0,0 +1,266 @@
+#ifndef CARTESIAN_ABSTRACTIONS_ADJACENCY_LISTS_H
+#define CARTESIAN_ABSTRACTIONS_ADJACENCY_LISTS_H
+
+#include "../utils/collections.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace cartesian_abstractions {
+/*
+  Store a growing number of lists (e.g., the transitions of each abstract
+  state) in a shared pool instead of one heap-allocated vector per list.
+
+  Each non-empty list occupies a block whose capacity is given by its size
+  class. Capacities grow by about 25% from one class to the next (1, 2, 3, 4,
+  5, 6, 7, 8, 10, 12, 14, 16, 20, ...), so at most a fifth of a block is
+  unused, whereas vectors double their capacity. When a list outgrows its
+  block, we move it to a block of the next size class and put the old block
+  on the free list of its class, where it can be reused by any other list.
+  Blocks are carved from chunks that double in size up to CHUNK_SIZE
+  elements, so small abstractions only need little memory. Blocks larger than
+  a chunk get a chunk of their own.
+  Chunks are never reallocated or returned to the system, so growing the
+  pool has no memory spike and adding elements causes no heap allocations
+  once the pool has reached its peak size.
+
+  Like vector::erase(), removing elements never shrinks the block of a list.
+  Clearing a list releases its block.
+*/
+template<typename T>
+class AdjacencyLists {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "AdjacencyLists moves elements with memcpy semantics");
+
+    static const int MIN_CHUNK_SIZE = 1 << 6;
+    static const int CHUNK_SIZE = 1 << 14;
+    static const int NO_BLOCK = -1;
+
+    struct List {
+        T *data;
+        int size;
+        int size_class;
+
+        List()
+            : data(nullptr),
+              size(0),
+              size_class(NO_BLOCK) {
+        }
+    };
+
+    std::vector<List> lists;
+    std::vector<std::unique_ptr<T[]>> chunks;
+    // Unused part of the last regular chunk.
+    T *chunk_begin;
+    int chunk_remaining;
+    std::vector<std::vector<T *>> free_blocks;
+    int64_t num_allocated_elements;
+    int64_t num_elements;
+
+    static const std::vector<int> &get_capacities() {
+        static const std::vector<int> capacities = [] {
+                std::vector<int> result;
+                int64_t capacity = 1;
+                while (capacity <= std::numeric_limits<int>::max()) {
+                    result.push_back(capacity);
+                    int64_t power_of_two = 1;
+                    while (2 * power_of_two <= capacity) {
+                        power_of_two *= 2;
+                    }
+                    capacity += std::max<int64_t>(1, power_of_two / 4);
+                }
+                return result;
+            }();
+        return capacities;
+    }
+
+    static int get_capacity(int size_class) {
+        return get_capacities()[size_class];
+    }
+
+    static int get_largest_size_class_fitting(int num_elements) {
+        assert(num_elements > 0);
+        const std::vector<int> &capacities = get_capacities();
+        return std::upper_bound(capacities.begin(), capacities.end(), num_elements)
+               - capacities.begin() - 1;
+    }
+
+    T *allocate_chunk(int chunk_size) {
+        chunks.emplace_back(new T[chunk_size]);
+        num_allocated_elements += chunk_size;
+        return chunks.back().get();
+    }
+
+    void release_block(T *block, int size_class) {
+        free_blocks[size_class].push_back(block);
+    }
+
+    // Hand the rest of the current chunk to the free lists.
+    void release_rest_of_chunk() {
+        while (chunk_remaining > 0) {
+            int size_class = get_largest_size_class_fitting(chunk_remaining);
+            release_block(chunk_begin, size_class);
+            chunk_begin += get_capacity(size_class);
+            chunk_remaining -= get_capacity(size_class);
+        }
+    }
+
+    T *allocate_block(int size_class) {
+        std::vector<T *> &blocks = free_blocks[size_class];
+        if (!blocks.empty()) {
+            T *block = blocks.back();
+            blocks.pop_back();
+            return block;
+        }
+        int capacity = get_capacity(size_class);
+        if (capacity > CHUNK_SIZE) {
+            return allocate_chunk(capacity);
+        }
+        if (capacity > chunk_remaining) {
+            release_rest_of_chunk();
+            int chunk_size = std::max<int64_t>(
+                capacity, std::min<int64_t>(
+                    CHUNK_SIZE, std::max<int64_t>(MIN_CHUNK_SIZE, num_allocated_elements)));
+            chunk_begin = allocate_chunk(chunk_size);
+            chunk_remaining = chunk_size;
+        }
+        T *block = chunk_begin;
+        chunk_begin += capacity;
+        chunk_remaining -= capacity;
+        return block;
+    }
+
+    void grow(List &list) {
+        int new_size_class = list.size_class + 1;
+        assert(new_size_class < static_cast<int>(free_blocks.size()));
+        T *block = allocate_block(new_size_class);
+        if (list.data) {
+            std::copy(list.data, list.data + list.size, block);
+            release_block(list.data, list.size_class);
+        }
+        list.data = block;
+        list.size_class = new_size_class;
+    }
+
+public:
+    // Read-only view of a single list. Invalidated by changes to any list.
+    class ListView {
+        const T *first;
+        const T *last;
+
+    public:
+        ListView(const T *first, const T *last)
+            : first(first),
+              last(last) {
+        }
+
+        const T *begin() const {
+            return first;
+        }
+
+        const T *end() const {
+            return last;
+        }
+
+        int size() const {
+            return last - first;
+        }
+
+        bool empty() const {
+            return first == last;
+        }
+
+        const T &operator[](int index) const {
+            assert(index >= 0 && index < size());
+            return first[index];
+        }
+
+        friend std::ostream &operator<<(std::ostream &os, const ListView &view) {
+            os << "[";
+            for (const T *it = view.first; it != view.last; ++it) {
+                if (it != view.first)
+                    os << ", ";
+                os << *it;
+            }
+            return os << "]";
+        }
+    };
+
+    AdjacencyLists()
+        : chunk_begin(nullptr),
+          chunk_remaining(0),
+          free_blocks(get_capacities().size()),
+          num_allocated_elements(0),
+          num_elements(0) {
+    }
+
+    AdjacencyLists(const AdjacencyLists &) = delete;
+    AdjacencyLists &operator=(const AdjacencyLists &) = delete;
+
+    // Append an empty list.
+    void add_list() {
+        lists.emplace_back();
+    }
+
+    size_t size() const {
+        return lists.size();
+    }
+
+    ListView operator[](int list_id) const {
+        assert(utils::in_bounds(list_id, lists));
+        const List &list = lists[list_id];
+        return ListView(list.data, list.data + list.size);
+    }
+
+    void push_back(int list_id, const T &value) {
+        assert(utils::in_bounds(list_id, lists));
+        List &list = lists[list_id];
+        if (list.size_class == NO_BLOCK || list.size == get_capacity(list.size_class)) {
+            grow(list);
+        }
+        list.data[list.size++] = value;
+        ++num_elements;
+    }
+
+    // Remove all elements matching the predicate, preserving the order of
+    // the others. Return the number of removed elements.
+    template<typename Predicate>
+    int remove_if(int list_id, Predicate pred) {
+        assert(utils::in_bounds(list_id, lists));
+        List &list = lists[list_id];
+        T *new_end = std::remove_if(list.data, list.data + list.size, pred);
+        int num_removed = (list.data + list.size) - new_end;
+        list.size -= num_removed;
+        num_elements -= num_removed;
+        return num_removed;
+    }
+
+    // Remove all elements from the list and release its block.
+    void clear(int list_id) {
+        assert(utils::in_bounds(list_id, lists));
+        List &list = lists[list_id];
+        if (list.data) {
+            release_block(list.data, list.size_class);
+        }
+        num_elements -= list.size;
+        list = List();
+    }
+
+    int64_t get_num_elements() const {
+        return num_elements;
+    }
+
+    int64_t estimate_memory_in_bytes() const {
+        return num_allocated_elements * sizeof(T) +
+               lists.capacity() * sizeof(List);
+    }
+};
+}
+
+#endif
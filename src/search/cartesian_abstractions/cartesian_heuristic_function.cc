@@ -1,6 +1,6 @@
 #include "cartesian_heuristic_function.h"
 
-#include "refinement_hierarchy.h"
+#include "compiled_refinement_hierarchy.h"
 
 #include "../utils/collections.h"
 
@@ -8,7 +8,7 @@ using namespace std;
 
 namespace cartesian_abstractions {
 CartesianHeuristicFunction::CartesianHeuristicFunction(
-    unique_ptr<RefinementHierarchy> &&hierarchy,
+    unique_ptr<CompiledRefinementHierarchy> &&hierarchy,
     vector<int> &&h_values)
     : refinement_hierarchy(move(hierarchy)),
       h_values(move(h_values)) {
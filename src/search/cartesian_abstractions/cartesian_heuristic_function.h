@@ -7,19 +7,19 @@
 class State;
 
 namespace cartesian_abstractions {
-class RefinementHierarchy;
+class CompiledRefinementHierarchy;
 /*
-  Store RefinementHierarchy and heuristic values for looking up abstract state
+  Store CompiledRefinementHierarchy and heuristic values for looking up abstract state
   IDs and corresponding heuristic values efficiently.
 */
 class CartesianHeuristicFunction {
     // Avoid const to enable moving.
-    std::unique_ptr<RefinementHierarchy> refinement_hierarchy;
+    std::unique_ptr<CompiledRefinementHierarchy> refinement_hierarchy;
     std::vector<int> h_values;
 
 public:
     CartesianHeuristicFunction(
-        std::unique_ptr<RefinementHierarchy> &&hierarchy,
+        std::unique_ptr<CompiledRefinementHierarchy> &&hierarchy,
         std::vector<int> &&h_values);
 
     CartesianHeuristicFunction(const CartesianHeuristicFunction &) = delete;
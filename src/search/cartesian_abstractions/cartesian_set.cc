@@ -1,25 +1,38 @@
 #include "cartesian_set.h"
 
+#include <algorithm>
+#include <bit>
 #include <sstream>
 
 using namespace std;
 
 namespace cartesian_abstractions {
-CartesianSet::CartesianSet(const vector<int> &domain_sizes) {
-    domain_subsets.reserve(domain_sizes.size());
+CartesianSet::Layout::Layout(const vector<int> &domain_sizes)
+    : domain_sizes(domain_sizes) {
+    var_offsets.reserve(domain_sizes.size() + 1);
+    int num_words = 0;
     for (int domain_size : domain_sizes) {
-        Bitset domain(domain_size);
-        domain.set();
-        domain_subsets.push_back(move(domain));
+        var_offsets.push_back(num_words);
+        num_words += (domain_size + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    }
+    var_offsets.push_back(num_words);
+}
+
+CartesianSet::CartesianSet(const vector<int> &domain_sizes)
+    : layout(make_shared<Layout>(domain_sizes)),
+      words(layout->get_num_words(), 0) {
+    int num_vars = domain_sizes.size();
+    for (int var = 0; var < num_vars; ++var) {
+        add_all(var);
     }
 }
 
 void CartesianSet::add(int var, int value) {
-    domain_subsets[var].set(value);
+    words[get_word_index(var, value)] |= get_mask(value);
 }
 
 void CartesianSet::remove(int var, int value) {
-    domain_subsets[var].reset(value);
+    words[get_word_index(var, value)] &= ~get_mask(value);
 }
 
 void CartesianSet::set_single_value(int var, int value) {
@@ -28,54 +41,72 @@ void CartesianSet::set_single_value(int var, int value) {
 }
 
 void CartesianSet::add_all(int var) {
-    domain_subsets[var].set();
+    int begin = layout->var_offsets[var];
+    int end = layout->var_offsets[var + 1];
+    fill(words.begin() + begin, words.begin() + end, ~Word(0));
+    // Zero the unused bits of the last word.
+    int bits_in_last_word = layout->domain_sizes[var] % BITS_PER_WORD;
+    if (bits_in_last_word != 0) {
+        words[end - 1] &= ~(~Word(0) << bits_in_last_word);
+    }
 }
 
 void CartesianSet::remove_all(int var) {
-    domain_subsets[var].reset();
+    fill(words.begin() + layout->var_offsets[var],
+         words.begin() + layout->var_offsets[var + 1], 0);
 }
 
 int CartesianSet::count(int var) const {
-    return domain_subsets[var].count();
+    int result = 0;
+    for (int i = layout->var_offsets[var]; i < layout->var_offsets[var + 1]; ++i) {
+        result += popcount(words[i]);
+    }
+    return result;
 }
 
 vector<int> CartesianSet::get_values(int var) const {
     vector<int> values;
-    int domain_size = domain_subsets[var].size();
-    for (int value = 0; value < domain_size; ++value) {
-        if (test(var, value)) {
-            values.push_back(value);
+    int offset = layout->var_offsets[var];
+    for (int i = offset; i < layout->var_offsets[var + 1]; ++i) {
+        Word word = words[i];
+        while (word) {
+            values.push_back((i - offset) * BITS_PER_WORD + countr_zero(word));
+            // Clear lowest set bit.
+            word &= word - 1;
         }
     }
     return values;
 }
 
 bool CartesianSet::intersects(const CartesianSet &other, int var) const {
-    return domain_subsets[var].intersects(other.domain_subsets[var]);
+    assert(layout == other.layout);
+    for (int i = layout->var_offsets[var]; i < layout->var_offsets[var + 1]; ++i) {
+        if (words[i] & other.words[i])
+            return true;
+    }
+    return false;
 }
 
 bool CartesianSet::is_superset_of(const CartesianSet &other) const {
-    int num_vars = domain_subsets.size();
-    for (int var = 0; var < num_vars; ++var) {
-        if (!other.domain_subsets[var].is_subset_of(domain_subsets[var]))
-            return false;
+    assert(layout == other.layout);
+    /* Combine all words without branching to allow the compiler to
+       vectorize the loop. */
+    Word missing = 0;
+    int num_words = words.size();
+    for (int i = 0; i < num_words; ++i) {
+        missing |= other.words[i] & ~words[i];
     }
-    return true;
+    return missing == 0;
 }
 
 ostream &operator<<(ostream &os, const CartesianSet &cartesian_set) {
-    int num_vars = cartesian_set.domain_subsets.size();
+    int num_vars = cartesian_set.layout->domain_sizes.size();
     string var_sep;
     os << "<";
     for (int var = 0; var < num_vars; ++var) {
-        const Bitset &domain = cartesian_set.domain_subsets[var];
-        vector<int> values;
-        for (size_t value = 0; value < domain.size(); ++value) {
-            if (domain[value])
-                values.push_back(value);
-        }
+        vector<int> values = cartesian_set.get_values(var);
         assert(!values.empty());
-        if (values.size() < domain.size()) {
+        if (static_cast<int>(values.size()) < cartesian_set.layout->domain_sizes[var]) {
             os << var_sep << var << "={";
             string value_sep;
             for (int value : values) {
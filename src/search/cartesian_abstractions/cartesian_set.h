@@ -1,21 +1,53 @@
 #ifndef CARTESIAN_ABSTRACTIONS_CARTESIAN_SET_H
 #define CARTESIAN_ABSTRACTIONS_CARTESIAN_SET_H
 
-#include "../algorithms/dynamic_bitset.h"
-
+#include <cassert>
+#include <cstdint>
+#include <memory>
 #include <ostream>
 #include <vector>
 
 namespace cartesian_abstractions {
-using Bitset = dynamic_bitset::DynamicBitset<unsigned short>;
-
 /*
   For each variable store a subset of its domain.
 
-  The underlying data structure is a vector of bitsets.
+  All domain subsets live in a single vector of 64-bit words. The subset of
+  each variable starts at a word boundary, so operations on a single variable
+  never have to mask bits of other variables, and operations on all
+  variables are tight loops over the words that the compiler can vectorize.
+  The word offsets of the variables only depend on the domain sizes, so all
+  Cartesian sets of an abstraction share them.
 */
 class CartesianSet {
-    std::vector<Bitset> domain_subsets;
+public:
+    using Word = uint64_t;
+
+private:
+    static const int BITS_PER_WORD = 64;
+
+    struct Layout {
+        // Index of the first word of each variable plus a sentinel.
+        std::vector<int> var_offsets;
+        std::vector<int> domain_sizes;
+
+        explicit Layout(const std::vector<int> &domain_sizes);
+
+        int get_num_words() const {
+            return var_offsets.back();
+        }
+    };
+
+    std::shared_ptr<const Layout> layout;
+    std::vector<Word> words;
+
+    static Word get_mask(int value) {
+        return Word(1) << (value % BITS_PER_WORD);
+    }
+
+    int get_word_index(int var, int value) const {
+        assert(value >= 0 && value < layout->domain_sizes[var]);
+        return layout->var_offsets[var] + value / BITS_PER_WORD;
+    }
 
 public:
     explicit CartesianSet(const std::vector<int> &domain_sizes);
@@ -27,7 +59,7 @@ public:
     void remove_all(int var);
 
     bool test(int var, int value) const {
-        return domain_subsets[var][value];
+        return words[get_word_index(var, value)] & get_mask(value);
     }
 
     int count(int var) const;
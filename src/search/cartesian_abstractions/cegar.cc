@@ -31,6 +31,8 @@ CEGAR::CEGAR(
     PickSplit tiebreak_split,
     int max_concrete_states_per_abstract_state,
     int max_state_expansions,
+    int flaw_search_threads,
+    bool store_loops,
     utils::RandomNumberGenerator &rng,
     utils::LogProxy &log,
     DotGraphVerbosity dot_graph_verbosity)
@@ -39,7 +41,7 @@ CEGAR::CEGAR(
       max_states(max_states),
       max_non_looping_transitions(max_non_looping_transitions),
       pick_flawed_abstract_state(pick_flawed_abstract_state),
-      abstraction(utils::make_unique_ptr<Abstraction>(task, log)),
+      abstraction(utils::make_unique_ptr<Abstraction>(task, store_loops, log)),
       timer(max_time),
       log(log),
       dot_graph_verbosity(dot_graph_verbosity) {
@@ -49,7 +51,8 @@ CEGAR::CEGAR(
     flaw_search = utils::make_unique_ptr<FlawSearch>(
         task, *abstraction, *shortest_paths, rng,
         pick_flawed_abstract_state, pick_split, tiebreak_split,
-        max_concrete_states_per_abstract_state, max_state_expansions, log);
+        max_concrete_states_per_abstract_state, max_state_expansions,
+        flaw_search_threads, log);
 
     if (log.is_at_least_normal()) {
         log << "Start building abstraction." << endl;
@@ -0,0 +1,380 @@
+#include "compiled_refinement_hierarchy.h"
+
+#include "refinement_hierarchy.h"
+#include "types.h"
+
+#include "../task_proxy.h"
+
+#include "../tasks/root_task.h"
+#include "../utils/serialization.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <unordered_set>
+
+using namespace std;
+
+namespace cartesian_abstractions {
+static const int SWITCH = -2;
+/* Only use a switch node if its table has at most this many entries per
+   node of the RefinementHierarchy that it replaces. */
+static const int MAX_SWITCH_CHILDREN_PER_NODE = 8;
+
+CompiledRefinementHierarchy::CompiledRefinementHierarchy(
+    const RefinementHierarchy &hierarchy)
+    : task(hierarchy.task) {
+    const vector<Node> &old_nodes = hierarchy.nodes;
+    VariablesProxy variables = TaskProxy(*task).get_variables();
+    const int UNCOMPILED = numeric_limits<int>::min();
+    vector<int> refs(old_nodes.size(), UNCOMPILED);
+    deque<NodeID> queue;
+    auto get_ref = [&](NodeID id) {
+            if (refs[id] == UNCOMPILED) {
+                const Node &node = old_nodes[id];
+                if (node.is_split()) {
+                    refs[id] = nodes.size();
+                    nodes.push_back(CompiledNode());
+                    queue.push_back(id);
+                } else {
+                    refs[id] = encode_state_id(node.get_state_id());
+                }
+            }
+            return refs[id];
+        };
+    // Count the nodes that test var and are reachable via such nodes.
+    auto count_nodes_testing_var = [&old_nodes](NodeID root_id, int var) {
+            unordered_set<NodeID> visited;
+            vector<NodeID> stack = {root_id};
+            while (!stack.empty()) {
+                NodeID id = stack.back();
+                stack.pop_back();
+                const Node &node = old_nodes[id];
+                if (node.is_split() && node.var == var && visited.insert(id).second) {
+                    stack.push_back(node.left_child);
+                    stack.push_back(node.right_child);
+                }
+            }
+            return static_cast<int>(visited.size());
+        };
+
+    root = get_ref(0);
+    while (!queue.empty()) {
+        NodeID id = queue.front();
+        queue.pop_front();
+        const Node &node = old_nodes[id];
+        int var = node.get_var();
+        int domain_size = variables[var].get_domain_size();
+        /* A switch node needs an additional memory access, so it only pays
+           off if it replaces at least two test nodes. */
+        int num_replaced_nodes = count_nodes_testing_var(id, var);
+        CompiledNode compiled;
+        compiled.var = var;
+        if (num_replaced_nodes >= 2 &&
+            domain_size <= MAX_SWITCH_CHILDREN_PER_NODE * num_replaced_nodes) {
+            compiled.value = SWITCH;
+            compiled.left_child = switch_children.size();
+            compiled.right_child = UNDEFINED;
+            for (int value = 0; value < domain_size; ++value) {
+                NodeID child_id = id;
+                while (old_nodes[child_id].is_split() &&
+                       old_nodes[child_id].get_var() == var) {
+                    child_id = old_nodes[child_id].get_child(value);
+                }
+                int child_ref = get_ref(child_id);
+                switch_children.push_back(child_ref);
+            }
+        } else {
+            compiled.value = node.value;
+            compiled.left_child = get_ref(node.left_child);
+            compiled.right_child = get_ref(node.right_child);
+        }
+        nodes[refs[id]] = compiled;
+    }
+    nodes.shrink_to_fit();
+    switch_children.shrink_to_fit();
+    num_states = count_states();
+    assert(is_valid());
+}
+
+CompiledRefinementHierarchy::CompiledRefinementHierarchy(istream &is)
+    : task(nullptr) {
+    static_assert(is_trivially_copyable_v<CompiledNode>);
+    int num_maps = utils::read_binary<int>(is);
+    for (int var = 0; var < num_maps && is; ++var) {
+        root_value_maps.push_back(utils::read_binary_vector<int>(is));
+    }
+    nodes = utils::read_binary_vector<CompiledNode>(is);
+    switch_children = utils::read_binary_vector<int>(is);
+    root = utils::read_binary<int>(is);
+    num_states = 0;
+    if (is && !is_valid()) {
+        is.setstate(ios::failbit);
+    } else if (is) {
+        num_states = count_states();
+    }
+}
+
+vector<int> CompiledRefinementHierarchy::get_num_lookup_values() const {
+    const AbstractTask &lookup_task = task ? *task : *tasks::g_root_task;
+    VariablesProxy variables = TaskProxy(lookup_task).get_variables();
+    int num_vars = variables.size();
+    vector<int> num_values(num_vars);
+    for (int var = 0; var < num_vars; ++var) {
+        num_values[var] = variables[var].get_domain_size();
+    }
+    if (root_value_maps.empty()) {
+        return num_values;
+    }
+    // Invalid value maps yield no lookup values.
+    if (static_cast<int>(root_value_maps.size()) != num_vars) {
+        return {};
+    }
+    for (int var = 0; var < num_vars; ++var) {
+        const vector<int> &value_map = root_value_maps[var];
+        if (static_cast<int>(value_map.size()) != num_values[var] ||
+            any_of(value_map.begin(), value_map.end(),
+                   [](int value) {return value < 0;})) {
+            return {};
+        }
+        num_values[var] = *max_element(value_map.begin(), value_map.end()) + 1;
+    }
+    return num_values;
+}
+
+bool CompiledRefinementHierarchy::is_valid() const {
+    vector<int> num_values = get_num_lookup_values();
+    int num_vars = num_values.size();
+    int num_nodes = nodes.size();
+    int64_t num_switch_children = switch_children.size();
+    // Each reference to a leaf can introduce at most one new state ID.
+    int64_t max_num_states = 2 * num_nodes + num_switch_children + 1;
+    vector<bool> state_id_used;
+    auto is_valid_ref = [&](int ref) {
+            if (ref >= 0) {
+                return ref < num_nodes;
+            }
+            if (ref == numeric_limits<int>::min() ||
+                encode_state_id(ref) >= max_num_states) {
+                return false;
+            }
+            int state_id = encode_state_id(ref);
+            if (state_id >= static_cast<int>(state_id_used.size())) {
+                state_id_used.resize(state_id + 1, false);
+            }
+            state_id_used[state_id] = true;
+            return true;
+        };
+    /* Nodes must only point to later nodes, which rules out cycles. A
+       negative reference is a leaf and always passes this test. */
+    auto is_later_node = [](int ref, int node_index) {
+            return ref < 0 || ref > node_index;
+        };
+
+    if ((!root_value_maps.empty() && num_values.empty()) || !is_valid_ref(root)) {
+        return false;
+    }
+    for (int ref : switch_children) {
+        if (!is_valid_ref(ref)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < num_nodes; ++i) {
+        const CompiledNode &node = nodes[i];
+        if (node.var < 0 || node.var >= num_vars) {
+            return false;
+        }
+        if (node.value == SWITCH) {
+            int64_t begin = node.left_child;
+            if (begin < 0 || begin + num_values[node.var] > num_switch_children) {
+                return false;
+            }
+            for (int value = 0; value < num_values[node.var]; ++value) {
+                if (!is_later_node(switch_children[begin + value], i)) {
+                    return false;
+                }
+            }
+        } else if (node.value < 0 ||
+                   !is_valid_ref(node.left_child) ||
+                   !is_valid_ref(node.right_child) ||
+                   !is_later_node(node.left_child, i) ||
+                   !is_later_node(node.right_child, i)) {
+            return false;
+        }
+    }
+    // The leaves must use the state IDs 0, ..., n-1.
+    return find(state_id_used.begin(), state_id_used.end(), false) ==
+           state_id_used.end();
+}
+
+int CompiledRefinementHierarchy::count_states() const {
+    // Since the state IDs are dense, the largest one determines the count.
+    int max_state_id = -1;
+    auto update = [&](int ref) {
+            if (ref < 0) {
+                max_state_id = max(max_state_id, encode_state_id(ref));
+            }
+        };
+    update(root);
+    for (int ref : switch_children) {
+        update(ref);
+    }
+    for (const CompiledNode &node : nodes) {
+        if (node.value != SWITCH) {
+            update(node.left_child);
+            update(node.right_child);
+        }
+    }
+    return max_state_id + 1;
+}
+
+template<typename ValueGetter>
+int CompiledRefinementHierarchy::lookup(const ValueGetter &get_value) const {
+    int ref = root;
+    while (ref >= 0) {
+        const CompiledNode &node = nodes[ref];
+        int value = get_value(node.var);
+        if (node.value == SWITCH) {
+            ref = switch_children[node.left_child + value];
+        } else {
+            ref = (value == node.value) ? node.right_child : node.left_child;
+        }
+    }
+    // The encoding is its own inverse.
+    return encode_state_id(ref);
+}
+
+int CompiledRefinementHierarchy::lookup_root_state(const State &state) const {
+    if (root_value_maps.empty()) {
+        return lookup([&state](int var) {return state[var].get_value();});
+    }
+    return lookup(
+        [this, &state](int var) {
+            return root_value_maps[var][state[var].get_value()];
+        });
+}
+
+int CompiledRefinementHierarchy::get_abstract_state_id(const State &state) const {
+    if (!task) {
+        return lookup_root_state(state);
+    }
+    TaskProxy subtask_proxy(*task);
+    if (subtask_proxy.needs_to_convert_ancestor_state(state)) {
+        State subtask_state = subtask_proxy.convert_ancestor_state(state);
+        return lookup([&subtask_state](int var) {return subtask_state[var].get_value();});
+    } else {
+        return lookup([&state](int var) {return state[var].get_value();});
+    }
+}
+
+void CompiledRefinementHierarchy::get_abstract_state_ids(
+    const vector<State> &states, vector<int> &state_ids) const {
+    int num_states = states.size();
+    /* Collect the (converted) state values up front, so the descent only
+       needs to access plain arrays. */
+    vector<vector<int>> converted_values;
+    vector<const int *> values(num_states);
+    if (task || !root_value_maps.empty()) {
+        converted_values.reserve(num_states);
+    }
+    for (int i = 0; i < num_states; ++i) {
+        const State &state = states[i];
+        state.unpack();
+        if (task && TaskProxy(*task).needs_to_convert_ancestor_state(state)) {
+            converted_values.push_back(
+                TaskProxy(*task).convert_ancestor_state(state).get_unpacked_values());
+            values[i] = converted_values.back().data();
+        } else if (!task && !root_value_maps.empty()) {
+            vector<int> mapped_values = state.get_unpacked_values();
+            int num_vars = root_value_maps.size();
+            for (int var = 0; var < num_vars; ++var) {
+                mapped_values[var] = root_value_maps[var][mapped_values[var]];
+            }
+            converted_values.push_back(move(mapped_values));
+            values[i] = converted_values.back().data();
+        } else {
+            values[i] = state.get_unpacked_values().data();
+        }
+    }
+
+    // Store the current node reference of each state in the output vector.
+    state_ids.assign(num_states, root);
+    vector<int> active_states;
+    if (root >= 0) {
+        active_states.resize(num_states);
+        iota(active_states.begin(), active_states.end(), 0);
+    }
+    while (!active_states.empty()) {
+        int num_active = 0;
+        for (int i : active_states) {
+            int &ref = state_ids[i];
+            const CompiledNode &node = nodes[ref];
+            int value = values[i][node.var];
+            if (node.value == SWITCH) {
+                ref = switch_children[node.left_child + value];
+            } else {
+                ref = (value == node.value) ? node.right_child : node.left_child;
+            }
+            if (ref >= 0) {
+                active_states[num_active++] = i;
+            }
+        }
+        active_states.resize(num_active);
+    }
+    for (int &ref : state_ids) {
+        ref = encode_state_id(ref);
+    }
+}
+
+vector<int> CompiledRefinementHierarchy::get_variables() const {
+    vector<int> variables;
+    for (const CompiledNode &node : nodes) {
+        variables.push_back(node.var);
+    }
+    sort(variables.begin(), variables.end());
+    variables.erase(unique(variables.begin(), variables.end()), variables.end());
+    return variables;
+}
+
+void CompiledRefinementHierarchy::save(ostream &os) const {
+    assert(task);
+    const AbstractTask *root_task = tasks::g_root_task.get();
+    vector<vector<int>> value_maps;
+    if (task->does_convert_ancestor_state_values(root_task)) {
+        /*
+          Convert states in which all variables have the same value (as far
+          as their domains allow). This needs one conversion per value of
+          the largest domain instead of one conversion per fact.
+        */
+        TaskProxy root_task_proxy(*root_task);
+        VariablesProxy variables = root_task_proxy.get_variables();
+        int num_vars = variables.size();
+        int max_domain_size = 0;
+        for (VariableProxy var : variables) {
+            value_maps.emplace_back(var.get_domain_size());
+            max_domain_size = max(max_domain_size, var.get_domain_size());
+        }
+        for (int value = 0; value < max_domain_size; ++value) {
+            vector<int> values(num_vars);
+            for (int var = 0; var < num_vars; ++var) {
+                values[var] = min(value, variables[var].get_domain_size() - 1);
+            }
+            task->convert_ancestor_state_values(values, root_task);
+            for (int var = 0; var < num_vars; ++var) {
+                if (value < variables[var].get_domain_size()) {
+                    value_maps[var][value] = values[var];
+                }
+            }
+        }
+    }
+    utils::write_binary<int>(os, value_maps.size());
+    for (const vector<int> &value_map : value_maps) {
+        utils::write_binary_vector(os, value_map);
+    }
+    utils::write_binary_vector(os, nodes);
+    utils::write_binary_vector(os, switch_children);
+    utils::write_binary<int>(os, root);
+}
+}
@@ -0,0 +1,108 @@
+#ifndef CARTESIAN_ABSTRACTIONS_COMPILED_REFINEMENT_HIERARCHY_H
+#define CARTESIAN_ABSTRACTIONS_COMPILED_REFINEMENT_HIERARCHY_H
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+class AbstractTask;
+class State;
+
+namespace cartesian_abstractions {
+class RefinementHierarchy;
+
+/*
+  Read-only version of a RefinementHierarchy for looking up abstract states
+  during the search.
+
+  We store the nodes in breadth-first order in a flat array and represent
+  leaves by their (encoded) state ID, so a lookup never visits a leaf node.
+  The RefinementHierarchy needs a chain of helper nodes for each split that
+  separates several values of a variable. The compiled hierarchy replaces
+  each maximal chain of at least two nodes that test the same variable by a
+  switch node with one child per value of the variable, if the switch table
+  is not much larger than the chain. Otherwise, we keep the binary test
+  nodes.
+*/
+class CompiledRefinementHierarchy {
+    struct CompiledNode {
+        int var;
+        // Split value for test nodes and SWITCH for switch nodes.
+        int value;
+        /* Children for test nodes (value != split value, value == split
+           value). For switch nodes, left_child is the offset of the
+           children in switch_children. */
+        int left_child;
+        int right_child;
+    };
+
+    /*
+      Hierarchies that have been loaded from a stream have no task. Instead,
+      root_value_maps[var][value] holds the subtask value for the given root
+      task value. If the subtask uses the root task values, the vector is empty.
+    */
+    std::shared_ptr<AbstractTask> task;
+    std::vector<std::vector<int>> root_value_maps;
+
+    // References to nodes are node indices (>= 0) or encoded state IDs (< 0).
+    std::vector<CompiledNode> nodes;
+    std::vector<int> switch_children;
+    int root;
+    int num_states;
+
+    static int encode_state_id(int state_id) {
+        return -state_id - 1;
+    }
+
+    template<typename ValueGetter>
+    int lookup(const ValueGetter &get_value) const;
+    int lookup_root_state(const State &state) const;
+    /* Return the number of values that lookups can pass for each variable,
+       or an empty vector if the root value maps are invalid. */
+    std::vector<int> get_num_lookup_values() const;
+    // Check that lookups stay within bounds and terminate.
+    bool is_valid() const;
+    // Return the number of distinct state IDs stored in the leaves.
+    int count_states() const;
+
+public:
+    explicit CompiledRefinementHierarchy(const RefinementHierarchy &hierarchy);
+    // Read a hierarchy that has been written with save().
+    explicit CompiledRefinementHierarchy(std::istream &is);
+
+    int get_abstract_state_id(const State &state) const;
+
+    /*
+      Compute the abstract state IDs for a batch of states. We descend the
+      hierarchy for all states in lockstep, which lets the processor overlap
+      the memory accesses for different states.
+    */
+    void get_abstract_state_ids(
+        const std::vector<State> &states, std::vector<int> &state_ids) const;
+
+    // Return the sorted variables that the hierarchy tests.
+    std::vector<int> get_variables() const;
+
+    int get_num_states() const {
+        return num_states;
+    }
+
+    int get_num_nodes() const {
+        return nodes.size();
+    }
+
+    int get_num_switch_children() const {
+        return switch_children.size();
+    }
+
+    /*
+      Write the hierarchy to a binary stream. The saved hierarchy can only
+      compute abstract state IDs for states of the root task. We assume that
+      the subtask converts the values of each variable independently.
+    */
+    void save(std::ostream &os) const;
+};
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "abstraction.h"
 #include "cartesian_heuristic_function.h"
 #include "cegar.h"
+#include "compiled_refinement_hierarchy.h"
 #include "refinement_hierarchy.h"
 #include "subtask_generators.h"
 #include "transition.h"
@@ -23,10 +24,11 @@ using namespace std;
 
 namespace cartesian_abstractions {
 static vector<int> compute_saturated_costs(
-    const TransitionSystem &transition_system,
+    const Abstraction &abstraction,
     const vector<int> &g_values,
     const vector<int> &h_values,
     bool use_general_costs) {
+    const TransitionSystem &transition_system = abstraction.get_transition_system();
     const int min_cost = use_general_costs ? -INF : 0;
     vector<int> saturated_costs(transition_system.get_num_operators(), min_cost);
     assert(g_values.size() == h_values.size());
@@ -62,9 +64,11 @@ static vector<int> compute_saturated_costs(
         if (use_general_costs) {
             /* To prevent negative cost cycles, all operators inducing
                self-loops must have non-negative costs. */
-            for (int op_id : transition_system.get_loops()[state_id]) {
-                saturated_costs[op_id] = max(saturated_costs[op_id], 0);
-            }
+            transition_system.for_each_loop(
+                abstraction.get_state(state_id),
+                [&saturated_costs](int op_id) {
+                    saturated_costs[op_id] = max(saturated_costs[op_id], 0);
+                });
         }
     }
     return saturated_costs;
@@ -82,6 +86,8 @@ CostSaturation::CostSaturation(
     PickSplit tiebreak_split,
     int max_concrete_states_per_abstract_state,
     int max_state_expansions,
+    int flaw_search_threads,
+    bool store_loops,
     int memory_padding_mb,
     utils::RandomNumberGenerator &rng,
     utils::LogProxy &log,
@@ -96,6 +102,8 @@ CostSaturation::CostSaturation(
       tiebreak_split(tiebreak_split),
       max_concrete_states_per_abstract_state(max_concrete_states_per_abstract_state),
       max_state_expansions(max_state_expansions),
+      flaw_search_threads(flaw_search_threads),
+      store_loops(store_loops),
       memory_padding_mb(memory_padding_mb),
       rng(rng),
       log(log),
@@ -210,6 +218,8 @@ void CostSaturation::build_abstractions(
             tiebreak_split,
             max_concrete_states_per_abstract_state,
             max_state_expansions,
+            flaw_search_threads,
+            store_loops,
             rng,
             log,
             dot_graph_verbosity);
@@ -229,7 +239,7 @@ void CostSaturation::build_abstractions(
             costs,
             abstraction->get_goals());
         vector<int> saturated_costs = compute_saturated_costs(
-            abstraction->get_transition_system(),
+            *abstraction,
             init_distances,
             goal_distances,
             use_general_costs);
@@ -243,7 +253,8 @@ void CostSaturation::build_abstractions(
             << endl << endl;
 
         heuristic_functions.emplace_back(
-            abstraction->extract_refinement_hierarchy(),
+            utils::make_unique_ptr<CompiledRefinementHierarchy>(
+                *abstraction->extract_refinement_hierarchy()),
             move(goal_distances));
         --rem_subtasks;
 
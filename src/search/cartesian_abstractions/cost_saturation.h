@@ -1,8 +1,8 @@
 #ifndef CARTESIAN_ABSTRACTIONS_COST_SATURATION_H
 #define CARTESIAN_ABSTRACTIONS_COST_SATURATION_H
 
+#include "compiled_refinement_hierarchy.h"
 #include "flaw_search.h"
-#include "refinement_hierarchy.h"
 #include "split_selector.h"
 
 #include <memory>
@@ -38,6 +38,8 @@ class CostSaturation {
     const PickSplit tiebreak_split;
     const int max_concrete_states_per_abstract_state;
     const int max_state_expansions;
+    const int flaw_search_threads;
+    const bool store_loops;
     const int memory_padding_mb;
     utils::RandomNumberGenerator &rng;
     utils::LogProxy &log;
@@ -71,6 +73,8 @@ public:
         PickSplit tiebreak_split,
         int max_concrete_states_per_abstract_state,
         int max_state_expansions,
+        int flaw_search_threads,
+        bool store_loops,
         int memory_padding_mb,
         utils::RandomNumberGenerator &rng,
         utils::LogProxy &log,
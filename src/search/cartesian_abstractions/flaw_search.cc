@@ -8,17 +8,28 @@
 #include "transition_system.h"
 #include "utils.h"
 
+#include "../concurrent_state_registry.h"
+
 #include "../plugins/plugin.h"
 #include "../task_utils/successor_generator.h"
 #include "../task_utils/task_properties.h"
 #include "../utils/countdown_timer.h"
+#include "../utils/parallel.h"
 #include "../utils/rng.h"
 
+#include <atomic>
+#include <chrono>
 #include <iterator>
 
 using namespace std;
 
 namespace cartesian_abstractions {
+static const int MIN_STATES_PER_THREAD = 64;
+
+static double get_elapsed_seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
 int FlawSearch::get_abstract_state_id(const State &state) const {
     return abstraction.get_abstract_state_id(state);
 }
@@ -369,6 +380,7 @@ unique_ptr<Split> FlawSearch::create_split(
 
 SearchStatus FlawSearch::search_for_flaws(const utils::CountdownTimer &cegar_timer) {
     flaw_search_timer.resume();
+    auto start_time = chrono::steady_clock::now();
     if (log.is_at_least_debug()) {
         log << "Search for flaws" << endl;
     }
@@ -410,6 +422,201 @@ SearchStatus FlawSearch::search_for_flaws(const utils::CountdownTimer &cegar_tim
         search_status = SOLVED;
     }
 
+    flaw_search_wall_clock_time += get_elapsed_seconds(start_time);
+    flaw_search_timer.stop();
+    return search_status;
+}
+
+SearchStatus FlawSearch::search_for_flaws_layer_by_layer(
+    const utils::CountdownTimer &cegar_timer) {
+    assert(pick_flawed_abstract_state == PickFlawedAbstractState::BATCH_MIN_H);
+    flaw_search_timer.resume();
+    auto start_time = chrono::steady_clock::now();
+    if (log.is_at_least_debug()) {
+        log << "Search for flaws with " << num_threads << " thread(s)" << endl;
+    }
+    ++num_searches;
+    last_refined_flawed_state = FlawedState::no_state;
+    assert(flawed_states.empty());
+    // Only flawed states are added to state_registry.
+    state_registry = utils::make_unique_ptr<StateRegistry>(task_proxy);
+    ConcurrentStateRegistry visited_states(task_proxy, num_threads);
+    const int_packer::IntPacker &state_packer = visited_states.get_state_packer();
+    int num_bins = visited_states.get_bins_per_state();
+
+    struct OpenState {
+        StateID id;
+        int abstract_state_id;
+    };
+    enum class Expansion : uint8_t {
+        NO_FLAW,
+        FLAW,
+        GOAL,
+        SKIPPED
+    };
+    vector<OpenState> layer;
+    layer.push_back(
+        {visited_states.insert_id_or_pop_state(
+             state_registry->get_initial_state().get_buffer(), 0).first,
+         abstraction.get_initial_state().get_id()});
+    size_t layer_pos = 0;
+
+    int num_expansions = 0;
+    int num_flawed_states = 0;
+    atomic<bool> out_of_memory(false);
+    vector<Expansion> expansions;
+    vector<vector<OpenState>> next_layers(num_threads);
+
+    SearchStatus search_status = IN_PROGRESS;
+    while (search_status == IN_PROGRESS) {
+        if (layer_pos == layer.size()) {
+            /* Sort the next layer by state data, so that the expansion
+               order doesn't depend on the number of threads or on the
+               thread scheduling. */
+            layer.clear();
+            for (vector<OpenState> &next_layer : next_layers) {
+                layer.insert(layer.end(), next_layer.begin(), next_layer.end());
+                next_layer.clear();
+            }
+            sort(layer.begin(), layer.end(),
+                 [&](const OpenState &lhs, const OpenState &rhs) {
+                     const PackedStateBin *lhs_buffer = visited_states.lookup_buffer(lhs.id);
+                     const PackedStateBin *rhs_buffer = visited_states.lookup_buffer(rhs.id);
+                     return lexicographical_compare(
+                         lhs_buffer, lhs_buffer + num_bins, rhs_buffer, rhs_buffer + num_bins);
+                 });
+            layer_pos = 0;
+        }
+        if (layer.empty()) {
+            // Completely explored f-optimal state space.
+            search_status = FAILED;
+            break;
+        }
+        if (cegar_timer.is_expired()) {
+            search_status = TIMEOUT;
+            break;
+        }
+
+        /* Expand the states up to the expansion limit, or the rest of the
+           layer once the limit is reached without flaws. */
+        size_t end = layer.size();
+        if (num_expansions < max_state_expansions) {
+            end = min(end, layer_pos + (max_state_expansions - num_expansions));
+        }
+        size_t num_states = end - layer_pos;
+        expansions.assign(num_states, Expansion::SKIPPED);
+        // We only need the results up to the first goal state.
+        atomic<size_t> first_goal_index(num_states);
+        // Starting threads is expensive, so we only use them for large chunks.
+        int num_chunk_threads = min<int>(
+            num_threads, (num_states + MIN_STATES_PER_THREAD - 1) / MIN_STATES_PER_THREAD);
+        atomic<size_t> next_index(0);
+        utils::run_in_parallel(num_chunk_threads, [&](int thread_id) {
+            vector<OpenState> &next_layer = next_layers[thread_id];
+            vector<PackedStateBin> buffer(num_bins);
+            while (!out_of_memory) {
+                size_t index = next_index++;
+                if (index >= num_states) {
+                    break;
+                }
+                if (index > first_goal_index) {
+                    continue;
+                }
+                const OpenState &open_state = layer[layer_pos + index];
+                State state = visited_states.lookup_state(open_state.id);
+
+                if (task_properties::is_goal_state(task_proxy, state)) {
+                    expansions[index] = Expansion::GOAL;
+                    size_t goal_index = first_goal_index;
+                    while (index < goal_index &&
+                           !first_goal_index.compare_exchange_weak(goal_index, index)) {
+                    }
+                    continue;
+                }
+
+                bool found_flaw = false;
+                for (auto &op_and_targets : get_f_optimal_transitions(open_state.abstract_state_id)) {
+                    if (!utils::extra_memory_padding_is_reserved()) {
+                        out_of_memory = true;
+                        break;
+                    }
+
+                    OperatorProxy op = task_proxy.get_operators()[op_and_targets.first];
+                    if (!task_properties::is_applicable(op, state)) {
+                        // Applicability flaw
+                        found_flaw = true;
+                        continue;
+                    }
+
+                    State succ_state = state.get_unregistered_successor(op);
+                    for (int target : op_and_targets.second) {
+                        if (!abstraction.get_state(target).includes(succ_state)) {
+                            // Deviation flaw
+                            found_flaw = true;
+                        } else {
+                            // No flaw
+                            fill(buffer.begin(), buffer.end(), 0);
+                            const vector<int> &values = succ_state.get_unpacked_values();
+                            for (size_t var = 0; var < values.size(); ++var) {
+                                state_packer.set(buffer.data(), var, values[var]);
+                            }
+                            pair<StateID, bool> result =
+                                visited_states.insert_id_or_pop_state(
+                                    buffer.data(), thread_id);
+                            if (result.second) {
+                                next_layer.push_back({result.first, target});
+                            }
+                        }
+                    }
+                }
+                expansions[index] = found_flaw ? Expansion::FLAW : Expansion::NO_FLAW;
+            }
+        });
+
+        if (out_of_memory) {
+            search_status = TIMEOUT;
+            break;
+        }
+
+        /* Process the expanded states in order, like a sequential search
+           would. If we stop before the end of the chunk, we discard the
+           remaining results and the next layer. */
+        for (size_t index = 0; index < num_states; ++index) {
+            ++num_expansions;
+            Expansion expansion = expansions[index];
+            assert(expansion != Expansion::SKIPPED);
+            if (expansion == Expansion::GOAL) {
+                search_status = SOLVED;
+                break;
+            } else if (expansion == Expansion::FLAW) {
+                const OpenState &open_state = layer[layer_pos + index];
+                State state = state_registry->register_state(
+                    visited_states.lookup_buffer(open_state.id));
+                add_flaw(open_state.abstract_state_id, state);
+                ++num_flawed_states;
+            }
+            // To remain complete, only take the expansions limit into account once at least one flaw has been found.
+            if (num_expansions >= max_state_expansions && num_flawed_states > 0) {
+                log << "Expansion limit reached with flaws." << endl;
+                search_status = FAILED;
+                break;
+            }
+        }
+        layer_pos = end;
+    }
+
+    if (search_status != FAILED) {
+        flawed_states.clear();
+    }
+
+    num_overall_expanded_concrete_states += num_expansions;
+    max_expanded_concrete_states = max(max_expanded_concrete_states,
+                                       num_expansions);
+    if (log.is_at_least_debug()) {
+        log << "Flaw search expanded " << num_expansions << " states." << endl;
+    }
+
+    flaw_search_wall_clock_time += get_elapsed_seconds(start_time);
     flaw_search_timer.stop();
     return search_status;
 }
@@ -484,7 +691,7 @@ FlawSearch::get_min_h_batch_split(const utils::CountdownTimer &cegar_timer) {
     FlawedState flawed_state = get_flawed_state_with_min_h();
     auto search_status = SearchStatus::FAILED;
     if (flawed_state == FlawedState::no_state) {
-        search_status = search_for_flaws(cegar_timer);
+        search_status = search_for_flaws_layer_by_layer(cegar_timer);
         if (search_status == SearchStatus::FAILED) {
             flawed_state = get_flawed_state_with_min_h();
         }
@@ -533,6 +740,7 @@ FlawSearch::FlawSearch(
     PickSplit tiebreak_split,
     int max_concrete_states_per_abstract_state,
     int max_state_expansions,
+    int num_threads,
     const utils::LogProxy &log) :
     task_proxy(*task),
     domain_sizes(get_domain_sizes(task_proxy)),
@@ -543,6 +751,7 @@ FlawSearch::FlawSearch(
     pick_flawed_abstract_state(pick_flawed_abstract_state),
     max_concrete_states_per_abstract_state(max_concrete_states_per_abstract_state),
     max_state_expansions(max_state_expansions),
+    num_threads(num_threads),
     log(log),
     silent_log(utils::get_silent_log()),
     last_refined_flawed_state(FlawedState::no_state),
@@ -552,7 +761,13 @@ FlawSearch::FlawSearch(
     max_expanded_concrete_states(0),
     flaw_search_timer(false),
     compute_splits_timer(false),
-    pick_split_timer(false) {
+    pick_split_timer(false),
+    flaw_search_wall_clock_time(0) {
+    if (num_threads > 1 &&
+        pick_flawed_abstract_state != PickFlawedAbstractState::BATCH_MIN_H) {
+        cerr << "Only batch_min_h supports multiple flaw search threads." << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+    }
 }
 
 unique_ptr<Split> FlawSearch::get_split(const utils::CountdownTimer &cegar_timer) {
@@ -636,6 +851,12 @@ void FlawSearch::print_statistics() const {
     log << "Maximum expanded concrete states in single flaw search: "
         << max_expanded_concrete_states << endl;
     log << "Flaw search time: " << flaw_search_timer << endl;
+    log << "Flaw search wall-clock time: " << flaw_search_wall_clock_time << "s" << endl;
+    if (num_threads > 1 && flaw_search_wall_clock_time > 0) {
+        log << "Flaw search threads: " << num_threads << endl;
+        log << "Flaw search speedup (CPU time / wall-clock time): "
+            << flaw_search_timer() / flaw_search_wall_clock_time << endl;
+    }
     log << "Time for computing splits: " << compute_splits_timer << endl;
     log << "Time for selecting splits: " << pick_split_timer << endl;
     if (num_searches > 0) {
@@ -665,6 +886,7 @@ static plugins::TypedEnumPlugin<PickFlawedAbstractState> _enum_plugin({
         {"batch_min_h",
          "Collect all flawed abstract states and iteratively refine them (by increasing "
          "h value). Only start a new flaw search once all remaining flawed abstract "
-         "states are refined. For each abstract state consider all concrete states."},
+         "states are refined. For each abstract state consider all concrete states. "
+         "The flaw search explores the concrete states breadth-first."},
     });
 }
@@ -48,6 +48,8 @@ class FlawSearch {
     const PickFlawedAbstractState pick_flawed_abstract_state;
     const int max_concrete_states_per_abstract_state;
     const int max_state_expansions;
+    // Only used for BATCH_MIN_H.
+    const int num_threads;
     mutable utils::LogProxy log;
     mutable utils::LogProxy silent_log;  // For concrete search space.
 
@@ -71,6 +73,8 @@ class FlawSearch {
     utils::Timer flaw_search_timer;
     utils::Timer compute_splits_timer;
     utils::Timer pick_split_timer;
+    // Our timers measure CPU time, so we also track wall-clock time.
+    double flaw_search_wall_clock_time;
 
     int get_abstract_state_id(const State &state) const;
     Cost get_h_value(int abstract_state_id) const;
@@ -80,6 +84,14 @@ class FlawSearch {
     void initialize();
     SearchStatus step();
     SearchStatus search_for_flaws(const utils::CountdownTimer &cegar_timer);
+    /*
+      Explore the f-optimal concrete state space layer by layer. The threads
+      share the states of the current layer and detect duplicates with a
+      ConcurrentStateRegistry. We expand each layer sorted by state data and
+      evaluate the expansions in this order, so the flaws and the chosen
+      splits only depend on the random seed, not on the number of threads.
+    */
+    SearchStatus search_for_flaws_layer_by_layer(const utils::CountdownTimer &cegar_timer);
 
     std::unique_ptr<Split> create_split(
         const std::vector<StateID> &state_ids, int abstract_state_id);
@@ -99,6 +111,7 @@ public:
         PickSplit tiebreak_split,
         int max_concrete_states_per_abstract_state,
         int max_state_expansions,
+        int num_threads,
         const utils::LogProxy &log);
 
     std::unique_ptr<Split> get_split(const utils::CountdownTimer &cegar_timer);
@@ -57,6 +57,7 @@ public:
     }
 
     friend std::ostream &operator<<(std::ostream &os, const Node &node);
+    friend class CompiledRefinementHierarchy;
 };
 
 /*
@@ -93,6 +94,7 @@ public:
 
     int get_abstract_state_id(const State &state) const;
     friend int Abstraction::get_abstract_state_id(const State &state) const;
+    friend class CompiledRefinementHierarchy;
 
     int get_num_nodes() const {
         return nodes.size();
@@ -0,0 +1,150 @@
+#include "refinement_hierarchy_benchmark.h"
+
+#include "abstraction.h"
+#include "abstract_state.h"
+#include "cegar.h"
+#include "compiled_refinement_hierarchy.h"
+#include "refinement_hierarchy.h"
+#include "shortest_paths.h"
+#include "transition_system.h"
+#include "types.h"
+
+#include "../plugins/plugin.h"
+#include "../task_utils/sampling.h"
+#include "../task_utils/task_properties.h"
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/rng.h"
+#include "../utils/rng_options.h"
+#include "../utils/timer.h"
+
+using namespace std;
+
+namespace cartesian_abstractions {
+static const int MEMORY_PADDING_MB = 100;
+
+static void print_lookup_speed(
+    utils::LogProxy &log, const string &name, int64_t num_lookups,
+    const utils::Timer &timer) {
+    double seconds = timer();
+    log << name << ": " << timer << ", "
+        << static_cast<int64_t>(num_lookups / max(seconds, 1e-9))
+        << " lookups/s" << endl;
+}
+
+RefinementHierarchyBenchmark::RefinementHierarchyBenchmark(
+    const plugins::Options &opts)
+    : Benchmark(opts, "refinement hierarchies"),
+      max_states(opts.get<int>("max_states")),
+      num_samples(opts.get<int>("samples")),
+      repetitions(opts.get<int>("repetitions")),
+      rng(utils::parse_rng_from_options(opts)) {
+}
+
+void RefinementHierarchyBenchmark::run_benchmark() {
+    utils::LogProxy silent_log = utils::get_silent_log();
+    // CEGAR stops refining when the memory padding is not reserved.
+    utils::reserve_extra_memory_padding(MEMORY_PADDING_MB);
+    CEGAR cegar(
+        task, max_states, numeric_limits<int>::max(), numeric_limits<double>::infinity(),
+        PickFlawedAbstractState::BATCH_MIN_H, PickSplit::MAX_COVER,
+        PickSplit::MAX_REFINED, numeric_limits<int>::max(), 1000000, 1, true,
+        *rng, silent_log, DotGraphVerbosity::SILENT);
+    unique_ptr<Abstraction> abstraction = cegar.extract_abstraction();
+    if (utils::extra_memory_padding_is_reserved()) {
+        utils::release_extra_memory_padding();
+    }
+    vector<int> goal_distances = compute_distances(
+        abstraction->get_transition_system().get_incoming_transitions(),
+        task_properties::get_operator_costs(task_proxy),
+        abstraction->get_goals());
+    int init_h = goal_distances[abstraction->get_initial_state().get_id()];
+    unique_ptr<RefinementHierarchy> hierarchy =
+        abstraction->extract_refinement_hierarchy();
+    CompiledRefinementHierarchy compiled_hierarchy(*hierarchy);
+    log << "Abstract states: " << abstraction->get_num_states() << endl;
+    log << "Hierarchy nodes: " << hierarchy->get_num_nodes() << endl;
+    log << "Compiled hierarchy nodes: " << compiled_hierarchy.get_num_nodes()
+        << ", switch children: " << compiled_hierarchy.get_num_switch_children()
+        << endl;
+
+    vector<State> samples;
+    samples.reserve(num_samples);
+    if (init_h == INF) {
+        samples.resize(num_samples, task_proxy.get_initial_state());
+    } else {
+        sampling::RandomWalkSampler sampler(task_proxy, *rng);
+        for (int i = 0; i < num_samples; ++i) {
+            samples.push_back(sampler.sample_state(init_h));
+        }
+    }
+    for (State &sample : samples) {
+        sample.unpack();
+    }
+    int64_t num_lookups = static_cast<int64_t>(num_samples) * repetitions;
+
+    vector<int> reference_ids(num_samples);
+    utils::Timer reference_timer;
+    for (int i = 0; i < repetitions; ++i) {
+        for (int j = 0; j < num_samples; ++j) {
+            reference_ids[j] = hierarchy->get_abstract_state_id(samples[j]);
+        }
+    }
+    reference_timer.stop();
+
+    vector<int> ids(num_samples);
+    utils::Timer timer;
+    for (int i = 0; i < repetitions; ++i) {
+        for (int j = 0; j < num_samples; ++j) {
+            ids[j] = compiled_hierarchy.get_abstract_state_id(samples[j]);
+        }
+    }
+    timer.stop();
+
+    vector<int> batch_ids;
+    utils::Timer batch_timer;
+    for (int i = 0; i < repetitions; ++i) {
+        compiled_hierarchy.get_abstract_state_ids(samples, batch_ids);
+    }
+    batch_timer.stop();
+
+    check(ids == reference_ids && batch_ids == reference_ids,
+          "Refinement hierarchies computed different abstract states.");
+    print_lookup_speed(log, "Refinement hierarchy", num_lookups, reference_timer);
+    print_lookup_speed(log, "Compiled refinement hierarchy", num_lookups, timer);
+    print_lookup_speed(
+        log, "Compiled refinement hierarchy (batch)", num_lookups, batch_timer);
+}
+
+class RefinementHierarchyBenchmarkFeature
+    : public plugins::TypedFeature<SearchAlgorithm, RefinementHierarchyBenchmark> {
+public:
+    RefinementHierarchyBenchmarkFeature() : TypedFeature("refinement_hierarchy_benchmark") {
+        document_title("Refinement hierarchy benchmark");
+        document_synopsis(
+            "Measures how many abstract state lookups per second the "
+            "refinement hierarchy of a Cartesian abstraction and its compiled "
+            "version perform for states sampled with random walks.");
+
+        add_option<int>(
+            "max_states",
+            "maximum number of abstract states",
+            "100000",
+            plugins::Bounds("1", "infinity"));
+        add_option<int>(
+            "samples",
+            "number of sampled states",
+            "1000",
+            plugins::Bounds("1", "infinity"));
+        add_option<int>(
+            "repetitions",
+            "number of lookups per sampled state",
+            "1000",
+            plugins::Bounds("1", "infinity"));
+        utils::add_rng_options(*this);
+        benchmark::add_benchmark_options_to_feature(*this);
+    }
+};
+
+static plugins::FeaturePlugin<RefinementHierarchyBenchmarkFeature> _plugin;
+}
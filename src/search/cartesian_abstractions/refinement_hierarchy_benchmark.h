@@ -0,0 +1,37 @@
+#ifndef CARTESIAN_ABSTRACTIONS_REFINEMENT_HIERARCHY_BENCHMARK_H
+#define CARTESIAN_ABSTRACTIONS_REFINEMENT_HIERARCHY_BENCHMARK_H
+
+#include "../search_algorithms/benchmark.h"
+
+#include <memory>
+
+namespace utils {
+class RandomNumberGenerator;
+}
+
+namespace cartesian_abstractions {
+/*
+  Compare the lookup speed of RefinementHierarchy and
+  CompiledRefinementHierarchy.
+
+  We build a Cartesian abstraction for the original task, sample states with
+  random walks and look up the abstract states of all samples for the given
+  number of repetitions, once with the RefinementHierarchy and once with the
+  CompiledRefinementHierarchy for single states and for the whole batch. The
+  benchmark checks that all lookups yield the same abstract states.
+*/
+class RefinementHierarchyBenchmark : public benchmark::Benchmark {
+    const int max_states;
+    const int num_samples;
+    const int repetitions;
+    const std::shared_ptr<utils::RandomNumberGenerator> rng;
+
+protected:
+    virtual void run_benchmark() override;
+
+public:
+    explicit RefinementHierarchyBenchmark(const plugins::Options &opts);
+};
+}
+
+#endif
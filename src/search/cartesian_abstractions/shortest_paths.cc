@@ -1,5 +1,6 @@
 #include "shortest_paths.h"
 
+#include "adjacency_lists.h"
 #include "utils.h"
 
 #include "../algorithms/priority_queues.h"
@@ -57,7 +58,7 @@ Cost ShortestPaths::convert_to_64_bit_cost(int cost) const {
 }
 
 void ShortestPaths::recompute(
-    const vector<Transitions> &in, const Goals &goals) {
+    const TransitionLists &in, const Goals &goals) {
     open_queue.clear();
     shortest_path = Transitions(in.size());
     goal_distances = vector<Cost>(in.size(), INF_COSTS);
@@ -104,8 +105,8 @@ void ShortestPaths::mark_dirty(int state) {
 }
 
 void ShortestPaths::update_incrementally(
-    const vector<Transitions> &in,
-    const vector<Transitions> &out,
+    const TransitionLists &in,
+    const TransitionLists &out,
     int v, int v1, int v2) {
     assert(in.size() == out.size());
     int num_states = in.size();
@@ -327,8 +328,8 @@ bool ShortestPaths::is_optimal_transition(int start_id, int op_id, int target_id
 }
 
 bool ShortestPaths::test_distances(
-    const vector<Transitions> &in,
-    const vector<Transitions> &out,
+    const TransitionLists &in,
+    const TransitionLists &out,
     const Goals &goals) {
     assert(none_of(goal_distances.begin(), goal_distances.end(),
                    [](Cost d) {return d == DIRTY;}));
@@ -389,7 +390,7 @@ bool ShortestPaths::test_distances(
 }
 
 vector<int> compute_distances(
-    const vector<Transitions> &transitions,
+    const TransitionLists &transitions,
     const vector<int> &costs,
     const unordered_set<int> &start_ids) {
     vector<int> distances(transitions.size(), INF);
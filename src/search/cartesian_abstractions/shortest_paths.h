@@ -105,12 +105,12 @@ public:
 
     // Use Dijkstra's algorithm to compute the shortest path tree from scratch.
     void recompute(
-        const std::vector<Transitions> &transitions,
+        const TransitionLists &transitions,
         const Goals &goals);
     // Reflect the split of v into v1 and v2.
     void update_incrementally(
-        const std::vector<Transitions> &in,
-        const std::vector<Transitions> &out,
+        const TransitionLists &in,
+        const TransitionLists &out,
         int v, int v1, int v2);
     // Extract solution from shortest path tree.
     std::unique_ptr<Solution> extract_solution(
@@ -123,13 +123,13 @@ public:
 
     // For debugging.
     bool test_distances(
-        const std::vector<Transitions> &in,
-        const std::vector<Transitions> &out,
+        const TransitionLists &in,
+        const TransitionLists &out,
         const Goals &goals);
 };
 
 std::vector<int> compute_distances(
-    const std::vector<Transitions> &transitions,
+    const TransitionLists &transitions,
     const std::vector<int> &costs,
     const std::unordered_set<int> &start_ids);
 }
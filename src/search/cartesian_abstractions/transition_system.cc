@@ -10,6 +10,7 @@
 #include "../utils/logging.h"
 
 #include <algorithm>
+#include <iterator>
 #include <map>
 
 using namespace std;
@@ -56,6 +57,40 @@ static vector<vector<FactPair>> get_postconditions_by_operator(
     return postconditions_by_operator;
 }
 
+static vector<vector<FactPair>> get_loop_conditions_by_operator(
+    const vector<vector<FactPair>> &preconditions_by_operator,
+    const vector<vector<FactPair>> &postconditions_by_operator) {
+    int num_operators = preconditions_by_operator.size();
+    vector<vector<FactPair>> loop_conditions_by_operator;
+    loop_conditions_by_operator.reserve(num_operators);
+    for (int op_id = 0; op_id < num_operators; ++op_id) {
+        const vector<FactPair> &pre = preconditions_by_operator[op_id];
+        const vector<FactPair> &post = postconditions_by_operator[op_id];
+        vector<FactPair> loop_conditions;
+        loop_conditions.reserve(pre.size() + post.size());
+        set_union(pre.begin(), pre.end(), post.begin(), post.end(),
+                  back_inserter(loop_conditions));
+        loop_conditions.shrink_to_fit();
+        loop_conditions_by_operator.push_back(move(loop_conditions));
+    }
+    return loop_conditions_by_operator;
+}
+
+static vector<vector<int>> get_operators_by_postcondition_var(
+    const vector<vector<FactPair>> &postconditions_by_operator, int num_vars) {
+    vector<vector<int>> operators_by_var(num_vars);
+    int num_operators = postconditions_by_operator.size();
+    for (int op_id = 0; op_id < num_operators; ++op_id) {
+        for (const FactPair &fact : postconditions_by_operator[op_id]) {
+            operators_by_var[fact.var].push_back(op_id);
+        }
+    }
+    for (vector<int> &operators : operators_by_var) {
+        operators.shrink_to_fit();
+    }
+    return operators_by_var;
+}
+
 static int lookup_value(const vector<FactPair> &facts, int var) {
     assert(is_sorted(facts.begin(), facts.end()));
     for (const FactPair &fact : facts) {
@@ -69,18 +104,26 @@ static int lookup_value(const vector<FactPair> &facts, int var) {
 }
 
 static void remove_transitions_with_given_target(
-    Transitions &transitions, int state_id) {
-    auto new_end = remove_if(
-        transitions.begin(), transitions.end(),
-        [state_id](const Transition &t) {return t.target_id == state_id;});
-    assert(new_end != transitions.end());
-    transitions.erase(new_end, transitions.end());
+    TransitionLists &transitions, int list_id, int state_id) {
+    int num_removed = transitions.remove_if(
+        list_id, [state_id](const Transition &t) {return t.target_id == state_id;});
+    utils::unused_variable(num_removed);
+    assert(num_removed > 0);
 }
 
 
-TransitionSystem::TransitionSystem(const OperatorsProxy &ops)
+TransitionSystem::TransitionSystem(
+    const OperatorsProxy &ops, int num_vars, bool store_loops)
     : preconditions_by_operator(get_preconditions_by_operator(ops)),
       postconditions_by_operator(get_postconditions_by_operator(ops)),
+      store_loops(store_loops),
+      loop_conditions_by_operator(
+          store_loops ? vector<vector<FactPair>>() :
+          get_loop_conditions_by_operator(
+              preconditions_by_operator, postconditions_by_operator)),
+      operators_by_postcondition_var(
+          store_loops ? vector<vector<int>>() :
+          get_operators_by_postcondition_var(postconditions_by_operator, num_vars)),
       num_non_loops(0),
       num_loops(0) {
     add_loops_in_trivial_abstraction();
@@ -95,10 +138,11 @@ int TransitionSystem::get_postcondition_value(int op_id, int var) const {
 }
 
 void TransitionSystem::enlarge_vectors_by_one() {
-    int new_num_states = get_num_states() + 1;
-    outgoing.resize(new_num_states);
-    incoming.resize(new_num_states);
-    loops.resize(new_num_states);
+    outgoing.add_list();
+    incoming.add_list();
+    if (store_loops) {
+        loops.add_list();
+    }
 }
 
 void TransitionSystem::add_loops_in_trivial_abstraction() {
@@ -112,15 +156,27 @@ void TransitionSystem::add_loops_in_trivial_abstraction() {
 
 void TransitionSystem::add_transition(int src_id, int op_id, int target_id) {
     assert(src_id != target_id);
-    outgoing[src_id].emplace_back(op_id, target_id);
-    incoming[target_id].emplace_back(op_id, src_id);
+    outgoing.push_back(src_id, Transition(op_id, target_id));
+    incoming.push_back(target_id, Transition(op_id, src_id));
     ++num_non_loops;
 }
 
 void TransitionSystem::add_loop(int state_id, int op_id) {
-    assert(utils::in_bounds(state_id, loops));
-    loops[state_id].push_back(op_id);
-    ++num_loops;
+    if (store_loops) {
+        assert(utils::in_bounds(state_id, loops));
+        loops.push_back(state_id, op_id);
+        ++num_loops;
+    }
+}
+
+void TransitionSystem::collect_implicit_loops(const AbstractState &v, int var) {
+    assert(!store_loops);
+    old_loops_buffer.clear();
+    for (int op_id : operators_by_postcondition_var[var]) {
+        if (operator_induces_self_loop(v, op_id)) {
+            old_loops_buffer.push_back(op_id);
+        }
+    }
 }
 
 void TransitionSystem::rewire_incoming_transitions(
@@ -136,7 +192,7 @@ void TransitionSystem::rewire_incoming_transitions(
         int u_id = transition.target_id;
         bool is_new_state = updated_states.insert(u_id).second;
         if (is_new_state) {
-            remove_transitions_with_given_target(outgoing[u_id], v_id);
+            remove_transitions_with_given_target(outgoing, u_id, v_id);
         }
     }
     num_non_loops -= old_incoming.size();
@@ -181,7 +237,7 @@ void TransitionSystem::rewire_outgoing_transitions(
         int w_id = transition.target_id;
         bool is_new_state = updated_states.insert(w_id).second;
         if (is_new_state) {
-            remove_transitions_with_given_target(incoming[w_id], v_id);
+            remove_transitions_with_given_target(incoming, w_id, v_id);
         }
     }
     num_non_loops -= old_outgoing.size();
@@ -270,42 +326,86 @@ void TransitionSystem::rewire_loops(
             }
         }
     }
-    num_loops -= old_loops.size();
+    if (store_loops) {
+        num_loops -= old_loops.size();
+    }
 }
 
 void TransitionSystem::rewire(
     const AbstractStates &states, int v_id,
     const AbstractState &v1, const AbstractState &v2, int var) {
     // Retrieve old transitions and make space for new transitions.
-    Transitions old_incoming = move(incoming[v_id]);
-    Transitions old_outgoing = move(outgoing[v_id]);
-    Loops old_loops = move(loops[v_id]);
+    old_incoming_buffer.assign(incoming[v_id].begin(), incoming[v_id].end());
+    old_outgoing_buffer.assign(outgoing[v_id].begin(), outgoing[v_id].end());
+    if (store_loops) {
+        old_loops_buffer.assign(loops[v_id].begin(), loops[v_id].end());
+        loops.clear(v_id);
+    } else {
+        collect_implicit_loops(*states[v_id], var);
+    }
+    incoming.clear(v_id);
+    outgoing.clear(v_id);
     enlarge_vectors_by_one();
     int v1_id = v1.get_id();
     int v2_id = v2.get_id();
     utils::unused_variable(v1_id);
     utils::unused_variable(v2_id);
-    assert(incoming[v1_id].empty() && outgoing[v1_id].empty() && loops[v1_id].empty());
-    assert(incoming[v2_id].empty() && outgoing[v2_id].empty() && loops[v2_id].empty());
+    assert(incoming[v1_id].empty() && outgoing[v1_id].empty());
+    assert(incoming[v2_id].empty() && outgoing[v2_id].empty());
+    assert(!store_loops || (loops[v1_id].empty() && loops[v2_id].empty()));
 
     // Remove old transitions and add new transitions.
-    rewire_incoming_transitions(old_incoming, states, v_id, v1, v2, var);
-    rewire_outgoing_transitions(old_outgoing, states, v_id, v1, v2, var);
-    rewire_loops(old_loops, v1, v2, var);
+    rewire_incoming_transitions(old_incoming_buffer, states, v_id, v1, v2, var);
+    rewire_outgoing_transitions(old_outgoing_buffer, states, v_id, v1, v2, var);
+    rewire_loops(old_loops_buffer, v1, v2, var);
 }
 
-const vector<Transitions> &TransitionSystem::get_incoming_transitions() const {
+const TransitionLists &TransitionSystem::get_incoming_transitions() const {
     return incoming;
 }
 
-const vector<Transitions> &TransitionSystem::get_outgoing_transitions() const {
+const TransitionLists &TransitionSystem::get_outgoing_transitions() const {
     return outgoing;
 }
 
-const vector<Loops> &TransitionSystem::get_loops() const {
+const LoopLists &TransitionSystem::get_loops() const {
+    assert(store_loops);
     return loops;
 }
 
+bool TransitionSystem::stores_loops() const {
+    return store_loops;
+}
+
+bool TransitionSystem::operator_induces_self_loop(
+    const AbstractState &state, int op_id) const {
+    if (store_loops) {
+        for (int loop_op_id : loops[state.get_id()]) {
+            if (loop_op_id == op_id) {
+                return true;
+            }
+        }
+        return false;
+    }
+    assert(utils::in_bounds(op_id, loop_conditions_by_operator));
+    return state.includes(loop_conditions_by_operator[op_id]);
+}
+
+void TransitionSystem::for_each_loop(
+    const AbstractState &state, const function<void(int)> &callback) const {
+    if (store_loops) {
+        for (int op_id : loops[state.get_id()]) {
+            callback(op_id);
+        }
+    } else {
+        for (int op_id = 0; op_id < get_num_operators(); ++op_id) {
+            if (state.includes(loop_conditions_by_operator[op_id])) {
+                callback(op_id);
+            }
+        }
+    }
+}
+
 const vector<FactPair> &TransitionSystem::get_preconditions(int op_id) const {
     assert(utils::in_bounds(op_id, preconditions_by_operator));
     return preconditions_by_operator[op_id];
@@ -313,7 +413,7 @@ const vector<FactPair> &TransitionSystem::get_preconditions(int op_id) const {
 
 int TransitionSystem::get_num_states() const {
     assert(incoming.size() == outgoing.size());
-    assert(loops.size() == outgoing.size());
+    assert(!store_loops || loops.size() == outgoing.size());
     return outgoing.size();
 }
 
@@ -338,13 +438,22 @@ void TransitionSystem::print_statistics(utils::LogProxy &log) const {
         for (int state_id = 0; state_id < get_num_states(); ++state_id) {
             total_incoming_transitions += incoming[state_id].size();
             total_outgoing_transitions += outgoing[state_id].size();
-            total_loops += loops[state_id].size();
+            if (store_loops) {
+                total_loops += loops[state_id].size();
+            }
         }
         assert(total_outgoing_transitions == total_incoming_transitions);
         assert(get_num_loops() == total_loops);
         assert(get_num_non_loops() == total_outgoing_transitions);
-        log << "Looping transitions: " << total_loops << endl;
+        if (store_loops) {
+            log << "Looping transitions: " << total_loops << endl;
+        } else {
+            log << "Looping transitions: not stored" << endl;
+        }
         log << "Non-looping transitions: " << total_outgoing_transitions << endl;
+        int64_t memory_in_bytes = incoming.estimate_memory_in_bytes() +
+            outgoing.estimate_memory_in_bytes() + loops.estimate_memory_in_bytes();
+        log << "Transition system memory: " << memory_in_bytes / 1024 << " KB" << endl;
     }
 }
 
@@ -353,7 +462,9 @@ void TransitionSystem::dump() const {
         cout << "State " << i << endl;
         cout << "  in: " << incoming[i] << endl;
         cout << "  out: " << outgoing[i] << endl;
-        cout << "  loops: " << loops[i] << endl;
+        if (store_loops) {
+            cout << "  loops: " << loops[i] << endl;
+        }
     }
 }
 }
@@ -1,8 +1,11 @@
 #ifndef CARTESIAN_ABSTRACTIONS_TRANSITION_SYSTEM_H
 #define CARTESIAN_ABSTRACTIONS_TRANSITION_SYSTEM_H
 
+#include "adjacency_lists.h"
+#include "transition.h"
 #include "types.h"
 
+#include <functional>
 #include <vector>
 
 struct FactPair;
@@ -15,21 +18,45 @@ class LogProxy;
 namespace cartesian_abstractions {
 /*
   Rewire transitions after each split.
+
+  The transitions of all abstract states live in shared pools (see
+  AdjacencyLists), so splitting a state doesn't allocate memory per state.
+
+  If store_loops is false, we don't store self-loops. Instead, we derive them
+  from the loop conditions of the operators: an operator induces a self-loop
+  in an abstract state iff the state contains all pre- and postconditions of
+  the operator.
 */
 class TransitionSystem {
     const std::vector<std::vector<FactPair>> preconditions_by_operator;
     const std::vector<std::vector<FactPair>> postconditions_by_operator;
+    const bool store_loops;
+    // Union of pre- and postconditions. Only used if store_loops is false.
+    const std::vector<std::vector<FactPair>> loop_conditions_by_operator;
+    // Operators with a postcondition on var. Only used if store_loops is false.
+    const std::vector<std::vector<int>> operators_by_postcondition_var;
 
     // Transitions from and to other abstract states.
-    std::vector<Transitions> incoming;
-    std::vector<Transitions> outgoing;
+    TransitionLists incoming;
+    TransitionLists outgoing;
 
     // Store self-loops (operator indices) separately to save space.
-    std::vector<Loops> loops;
+    LoopLists loops;
+
+    // Buffers for the transitions of the split state, reused across splits.
+    Transitions old_incoming_buffer;
+    Transitions old_outgoing_buffer;
+    Loops old_loops_buffer;
 
     int num_non_loops;
+    // Only maintained if store_loops is true.
     int num_loops;
 
+    /* Store the operators that induce self-loops in v and have a
+       postcondition on var in old_loops_buffer. All other self-loops of v
+       are self-loops of both children after splitting v for var. */
+    void collect_implicit_loops(const AbstractState &v, int var);
+
     void enlarge_vectors_by_one();
 
     // Add self-loops to single abstract state in trivial abstraction.
@@ -52,16 +79,23 @@ class TransitionSystem {
         const AbstractState &v1, const AbstractState &v2, int var);
 
 public:
-    explicit TransitionSystem(const OperatorsProxy &ops);
+    TransitionSystem(const OperatorsProxy &ops, int num_vars, bool store_loops);
 
     // Update transition system after v has been split for var into v1 and v2.
     void rewire(
         const AbstractStates &states, int v_id,
         const AbstractState &v1, const AbstractState &v2, int var);
 
-    const std::vector<Transitions> &get_incoming_transitions() const;
-    const std::vector<Transitions> &get_outgoing_transitions() const;
-    const std::vector<Loops> &get_loops() const;
+    const TransitionLists &get_incoming_transitions() const;
+    const TransitionLists &get_outgoing_transitions() const;
+    // Only available if self-loops are stored.
+    const LoopLists &get_loops() const;
+
+    bool stores_loops() const;
+    bool operator_induces_self_loop(const AbstractState &state, int op_id) const;
+    // Call the callback for each operator that induces a self-loop in state.
+    void for_each_loop(
+        const AbstractState &state, const std::function<void(int)> &callback) const;
 
     const std::vector<FactPair> &get_preconditions(int op_id) const;
 
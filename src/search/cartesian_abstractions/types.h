@@ -10,6 +10,8 @@
 namespace cartesian_abstractions {
 class AbstractState;
 struct Transition;
+template<typename T>
+class AdjacencyLists;
 
 enum class DotGraphVerbosity {
     SILENT,
@@ -22,8 +24,10 @@ using Cost = uint64_t;
 using Goals = std::unordered_set<int>;
 using NodeID = int;
 using Loops = std::vector<int>;
+using LoopLists = AdjacencyLists<int>;
 using Solution = std::deque<Transition>;
 using Transitions = std::vector<Transition>;
+using TransitionLists = AdjacencyLists<Transition>;
 
 // Positive infinity. The name "INFINITY" is taken by an ISO C99 macro.
 const int INF = std::numeric_limits<int>::max();
@@ -157,7 +157,7 @@ string create_dot_graph(const TaskProxy &task_proxy, const Abstraction &abstract
     }
     for (int state_id = 0; state_id < num_states; ++state_id) {
         map<int, vector<int>> parallel_transitions;
-        auto transitions =
+        const TransitionLists &transitions =
             abstraction.get_transition_system().get_outgoing_transitions();
         for (const Transition &t : transitions[state_id]) {
             parallel_transitions[t.target_id].push_back(t.op_id);
@@ -230,6 +230,20 @@ void add_common_cegar_options(plugins::Feature &feature) {
         "maximum number of state expansions per flaw search",
         "1M",
         plugins::Bounds("1", "infinity"));
+    feature.add_option<int>(
+        "flaw_search_threads",
+        "number of threads for the flaw search. Only batch_min_h supports "
+        "multiple threads. The chosen splits don't depend on the number of "
+        "threads.",
+        "1",
+        plugins::Bounds("1", "infinity"));
+    feature.add_option<bool>(
+        "store_loops",
+        "store self-loops explicitly. If false, compute self-loops from the "
+        "pre- and postconditions of the operators when needed. This saves "
+        "memory if there are many self-loops, but makes queries for "
+        "self-loops slower.",
+        "true");
 }
 
 static plugins::TypedEnumPlugin<DotGraphVerbosity> _enum_plugin({
@@ -27,6 +27,13 @@ option USE_LP to false."
             "not supported when an LP solver is used. See issue982 for details.")
     endif()
 
+    option(
+        BUILD_BENCHMARKS
+        "Compile the benchmark plugins (e.g., open_list_benchmark), which compare \
+the running times of two implementations of a data structure. They are only \
+useful for developers."
+        FALSE)
+
     option(
         DISABLE_LIBRARIES_BY_DEFAULT
         "If set to YES only libraries that are specifically enabled will be compiled"
@@ -0,0 +1,164 @@
+#include "concurrent_state_registry.h"
+
+#include "task_utils/task_properties.h"
+#include "utils/collections.h"
+#include "utils/hash.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+#include "utils/system.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <unordered_map>
+
+using namespace std;
+
+static const int SEGMENT_SIZE_IN_BYTES = 1 << 16;
+
+static int get_num_bits(int max_value) {
+    int num_bits = 0;
+    while ((1 << num_bits) < max_value) {
+        ++num_bits;
+    }
+    return num_bits;
+}
+
+ConcurrentStateRegistry::StatePool::StatePool(int bins_per_state, int max_states)
+    : bins_per_state(bins_per_state),
+      states_per_segment(
+          max(1, SEGMENT_SIZE_IN_BYTES / static_cast<int>(bins_per_state * sizeof(PackedStateBin)))),
+      max_segments(static_cast<int>(
+                       (static_cast<long long>(max_states) + states_per_segment - 1) /
+                       states_per_segment)),
+      segments(new atomic<PackedStateBin *>[max_segments]),
+      num_states(0) {
+    for (int i = 0; i < max_segments; ++i) {
+        segments[i].store(nullptr, memory_order_relaxed);
+    }
+}
+
+ConcurrentStateRegistry::StatePool::~StatePool() {
+    for (int i = 0; i < max_segments; ++i) {
+        delete[] segments[i].load(memory_order_relaxed);
+    }
+}
+
+int ConcurrentStateRegistry::StatePool::push_back(const PackedStateBin *buffer) {
+    int segment = num_states / states_per_segment;
+    if (segment == max_segments) {
+        return -1;
+    }
+    PackedStateBin *data = segments[segment].load(memory_order_relaxed);
+    if (!data) {
+        data = new PackedStateBin[states_per_segment * bins_per_state];
+        segments[segment].store(data, memory_order_release);
+    }
+    int offset = num_states % states_per_segment;
+    copy(buffer, buffer + bins_per_state, data + offset * bins_per_state);
+    return num_states++;
+}
+
+void ConcurrentStateRegistry::StatePool::pop_back() {
+    // We keep the memory of the last segment for the next state.
+    --num_states;
+}
+
+uint64_t ConcurrentStateRegistry::StateIDSemanticHash::operator()(int id) const {
+    const PackedStateBin *data = registry.lookup_buffer(StateID(id));
+    utils::HashState hash_state;
+    for (int i = 0; i < registry.bins_per_state; ++i) {
+        hash_state.feed(data[i]);
+    }
+    return hash_state.get_hash64();
+}
+
+bool ConcurrentStateRegistry::StateIDSemanticEqual::operator()(int lhs, int rhs) const {
+    const PackedStateBin *lhs_data = registry.lookup_buffer(StateID(lhs));
+    const PackedStateBin *rhs_data = registry.lookup_buffer(StateID(rhs));
+    return equal(lhs_data, lhs_data + registry.bins_per_state, rhs_data);
+}
+
+static atomic<int> next_registry_id(0);
+
+ConcurrentStateRegistry::ConcurrentStateRegistry(
+    const TaskProxy &task_proxy, int max_threads)
+    : task_proxy(task_proxy),
+      state_packer(task_properties::g_state_packers[task_proxy]),
+      bins_per_state(state_packer.get_num_bins()),
+      pool_bits(get_num_bits(max_threads)),
+      registry_id(next_registry_id++),
+      num_used_state_pools(0),
+      registered_states(
+          0,
+          StateIDSemanticHash(*this),
+          StateIDSemanticEqual(*this)) {
+    int num_pools = 1 << pool_bits;
+    // StateIDs are non-negative ints.
+    int max_states_per_pool = numeric_limits<int>::max() >> pool_bits;
+    state_pools.reserve(num_pools);
+    for (int i = 0; i < num_pools; ++i) {
+        state_pools.push_back(
+            utils::make_unique_ptr<StatePool>(bins_per_state, max_states_per_pool));
+    }
+}
+
+int ConcurrentStateRegistry::get_local_state_pool_id() {
+    // Map registry IDs to the pool that the current thread uses in that registry.
+    thread_local unordered_map<int, int> pool_ids;
+    auto it = pool_ids.find(registry_id);
+    if (it != pool_ids.end()) {
+        return it->second;
+    }
+    int pool_id = num_used_state_pools++;
+    if (pool_id >= static_cast<int>(state_pools.size())) {
+        cerr << "More threads than expected use the concurrent state registry."
+             << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+    }
+    pool_ids[registry_id] = pool_id;
+    return pool_id;
+}
+
+pair<StateID, bool> ConcurrentStateRegistry::insert_id_or_pop_state(
+    const PackedStateBin *buffer) {
+    return insert_id_or_pop_state(buffer, get_local_state_pool_id());
+}
+
+pair<StateID, bool> ConcurrentStateRegistry::insert_id_or_pop_state(
+    const PackedStateBin *buffer, int pool_id) {
+    assert(utils::in_bounds(pool_id, state_pools));
+    StatePool &pool = *state_pools[pool_id];
+    int index = pool.push_back(buffer);
+    if (index == -1) {
+        cerr << "Too many states for the concurrent state registry." << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_OUT_OF_MEMORY);
+    }
+    int id = (index << pool_bits) | pool_id;
+    /* Iterators are invalidated as soon as the shard is unlocked, so we read
+       the ID of an existing entry while holding the lock. */
+    int registered_id = id;
+    bool is_new_entry = registered_states.lazy_emplace_l(
+        id,
+        [&registered_id](int existing_id) {registered_id = existing_id;},
+        [id](const StateIDSet::constructor &ctor) {ctor(id);});
+    if (!is_new_entry) {
+        pool.pop_back();
+    }
+    return {StateID(registered_id), is_new_entry};
+}
+
+State ConcurrentStateRegistry::lookup_state(StateID id) const {
+    const PackedStateBin *buffer = lookup_buffer(id);
+    int num_variables = task_proxy.get_variables().size();
+    vector<int> values(num_variables);
+    for (int var = 0; var < num_variables; ++var) {
+        values[var] = state_packer.get(buffer, var);
+    }
+    return task_proxy.create_state(move(values));
+}
+
+void ConcurrentStateRegistry::print_statistics(utils::LogProxy &log) const {
+    log << "Number of registered states: " << size() << endl;
+    log << "Threads that registered states: " << num_used_state_pools << endl;
+}
@@ -0,0 +1,149 @@
+#ifndef CONCURRENT_STATE_REGISTRY_H
+#define CONCURRENT_STATE_REGISTRY_H
+
+#include "state_id.h"
+#include "state_registry.h"
+#include "task_proxy.h"
+
+#include <parallel_hashmap/phmap.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+  Thread-safe variant of StateRegistry. Multiple threads may register and
+  look up states concurrently.
+
+  Each thread appends the states it registers to its own pool, so storing
+  state data needs no synchronization. Duplicate detection uses a hash set
+  that is split into 2^NUM_SHARD_BITS shards with one mutex each, so threads
+  only contend if they access the same shard at the same time. A StateID
+  encodes the pool (i.e., the thread) that stores the state and the position
+  of the state in that pool.
+
+  States returned by lookup_state() are unregistered states, because State
+  objects can only refer to a StateRegistry. Use the StateIDs returned by
+  insert_id_or_pop_state() for identifying states.
+*/
+class ConcurrentStateRegistry {
+    /*
+      Append-only storage for the packed states registered by one thread.
+      Only the owning thread adds and removes states, but all threads may
+      read the states that have been published through the hash set.
+    */
+    class StatePool {
+        const int bins_per_state;
+        const int states_per_segment;
+        const int max_segments;
+        std::unique_ptr<std::atomic<PackedStateBin *>[]> segments;
+        int num_states;
+
+    public:
+        StatePool(int bins_per_state, int max_states);
+        ~StatePool();
+        StatePool(const StatePool &) = delete;
+        StatePool &operator=(const StatePool &) = delete;
+
+        // Return the index of the new state or -1 if the pool is full.
+        int push_back(const PackedStateBin *buffer);
+        void pop_back();
+
+        const PackedStateBin *operator[](int index) const {
+            PackedStateBin *segment =
+                segments[index / states_per_segment].load(std::memory_order_acquire);
+            return segment + (index % states_per_segment) * bins_per_state;
+        }
+    };
+
+    struct StateIDSemanticHash {
+        const ConcurrentStateRegistry &registry;
+        explicit StateIDSemanticHash(const ConcurrentStateRegistry &registry)
+            : registry(registry) {
+        }
+        uint64_t operator()(int id) const;
+    };
+
+    struct StateIDSemanticEqual {
+        const ConcurrentStateRegistry &registry;
+        explicit StateIDSemanticEqual(const ConcurrentStateRegistry &registry)
+            : registry(registry) {
+        }
+        bool operator()(int lhs, int rhs) const;
+    };
+
+    static const int NUM_SHARD_BITS = 6;
+
+    using StateIDSet = phmap::parallel_flat_hash_set<
+        int, StateIDSemanticHash, StateIDSemanticEqual,
+        phmap::priv::Allocator<int>, NUM_SHARD_BITS, std::mutex>;
+
+    TaskProxy task_proxy;
+    const int_packer::IntPacker &state_packer;
+    const int bins_per_state;
+    const int pool_bits;
+    // Used for mapping threads to their pools.
+    const int registry_id;
+    std::vector<std::unique_ptr<StatePool>> state_pools;
+    std::atomic<int> num_used_state_pools;
+    StateIDSet registered_states;
+
+    int get_local_state_pool_id();
+
+public:
+    /*
+      At most max_threads different threads may register states. IDs use
+      log2(max_threads) bits for the pool, which limits the number of states
+      per thread to 2^31 / max_threads (rounded up to a power of two).
+    */
+    ConcurrentStateRegistry(const TaskProxy &task_proxy, int max_threads);
+
+    const TaskProxy &get_task_proxy() const {
+        return task_proxy;
+    }
+
+    const int_packer::IntPacker &get_state_packer() const {
+        return state_packer;
+    }
+
+    int get_bins_per_state() const {
+        return bins_per_state;
+    }
+
+    /*
+      Registers the state with the given packed data if this was not done
+      before. Returns its ID and whether the state is new. Like in
+      StateRegistry, we add the data to the pool first and remove it again if
+      the state is a duplicate. Thread-safe.
+    */
+    std::pair<StateID, bool> insert_id_or_pop_state(const PackedStateBin *buffer);
+
+    /*
+      Like insert_id_or_pop_state(buffer), but store the state in the pool
+      with the given ID in [0, max_threads) instead of the pool of the calling
+      thread. This is useful if new threads are started for each batch of
+      work. Callers must make sure that no two threads use the same pool at
+      the same time and must not mix the two variants for one registry.
+    */
+    std::pair<StateID, bool> insert_id_or_pop_state(
+        const PackedStateBin *buffer, int pool_id);
+
+    // Return the packed data of the state with the given ID. Thread-safe.
+    const PackedStateBin *lookup_buffer(StateID id) const {
+        int pool_id = id.value & ((1 << pool_bits) - 1);
+        return (*state_pools[pool_id])[id.value >> pool_bits];
+    }
+
+    // Return an unregistered copy of the state with the given ID. Thread-safe.
+    State lookup_state(StateID id) const;
+
+    size_t size() const {
+        return registered_states.size();
+    }
+
+    void print_statistics(utils::LogProxy &log) const;
+};
+
+#endif
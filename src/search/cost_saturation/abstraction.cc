@@ -1,10 +1,31 @@
 #include "abstraction.h"
 
+#include "cartesian_abstraction_generator.h"
+#include "projection.h"
+
+#include "../task_proxy.h"
+
+#include "../utils/memory.h"
+#include "../utils/serialization.h"
+
 #include <cassert>
 
 using namespace std;
 
 namespace cost_saturation {
+void AbstractionFunction::get_abstract_state_ids(
+    const vector<State> &states, vector<int> &state_ids) const {
+    state_ids.resize(states.size());
+    for (size_t i = 0; i < states.size(); ++i) {
+        state_ids[i] = get_abstract_state_id(states[i]);
+    }
+}
+
+int AbstractionFunction::get_hash_multiplier(int) const {
+    return -1;
+}
+
+
 Abstraction::Abstraction(unique_ptr<AbstractionFunction> abstraction_function)
     : abstraction_function(move(abstraction_function)) {
 }
@@ -14,7 +35,27 @@ int Abstraction::get_abstract_state_id(const State &concrete_state) const {
     return abstraction_function->get_abstract_state_id(concrete_state);
 }
 
+void Abstraction::get_abstract_state_ids(
+    const vector<State> &states, vector<int> &state_ids) const {
+    assert(abstraction_function);
+    abstraction_function->get_abstract_state_ids(states, state_ids);
+}
+
 unique_ptr<AbstractionFunction> Abstraction::extract_abstraction_function() {
     return move(abstraction_function);
 }
+
+unique_ptr<AbstractionFunction> load_abstraction_function(istream &is) {
+    AbstractionFunctionType type = utils::read_binary<AbstractionFunctionType>(is);
+    if (!is) {
+        return nullptr;
+    } else if (type == AbstractionFunctionType::PROJECTION) {
+        return utils::make_unique_ptr<ProjectionFunction>(is);
+    } else if (type == AbstractionFunctionType::CARTESIAN) {
+        return load_cartesian_abstraction_function(is);
+    } else {
+        is.setstate(ios::failbit);
+        return nullptr;
+    }
+}
 }
@@ -2,7 +2,9 @@
 #define COST_SATURATION_ABSTRACTION_H
 
 #include <cassert>
+#include <cstdint>
 #include <functional>
+#include <istream>
 #include <memory>
 #include <ostream>
 #include <vector>
@@ -41,12 +43,48 @@ struct Transition {
 };
 
 
+// Tags for telling the types of saved abstraction functions apart.
+enum class AbstractionFunctionType : std::uint8_t {
+    PROJECTION,
+    CARTESIAN
+};
+
 class AbstractionFunction {
 public:
     virtual ~AbstractionFunction() = default;
     virtual int get_abstract_state_id(const State &concrete_state) const = 0;
+
+    /*
+      Store the abstract state ID of states[i] in state_ids[i]. Subclasses
+      override this method to handle a batch of states in a single loop
+      without a virtual call per state.
+    */
+    virtual void get_abstract_state_ids(
+        const std::vector<State> &states, std::vector<int> &state_ids) const;
+
+    // Return the sorted variables on which the abstract state IDs depend.
+    virtual std::vector<int> get_variables() const = 0;
+
+    /*
+      If abstract state IDs are weighted sums of variable values (as for
+      projections), return the weight of var. This allows updating the ID of
+      a state whose value of var changes by adding the weighted difference.
+      Otherwise, return -1.
+    */
+    virtual int get_hash_multiplier(int var) const;
+
+    // Return the number of abstract states, i.e., the bound for the IDs.
+    virtual int get_num_states() const = 0;
+
+    /*
+      Write the type tag followed by the data of the function to a binary
+      stream. Use load_abstraction_function() to read it back.
+    */
+    virtual void save(std::ostream &os) const = 0;
 };
 
+extern std::unique_ptr<AbstractionFunction> load_abstraction_function(std::istream &is);
+
 
 class Abstraction {
 protected:
@@ -79,6 +117,8 @@ public:
     virtual const std::vector<int> &get_goal_states() const = 0;
 
     int get_abstract_state_id(const State &concrete_state) const;
+    void get_abstract_state_ids(
+        const std::vector<State> &states, std::vector<int> &state_ids) const;
     std::unique_ptr<AbstractionFunction> extract_abstraction_function();
 
     virtual void dump() const = 0;
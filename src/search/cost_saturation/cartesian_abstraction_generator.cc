@@ -3,9 +3,12 @@
 #include "explicit_abstraction.h"
 #include "types.h"
 
+#include "../axioms.h"
+
 #include "../cartesian_abstractions/abstraction.h"
 #include "../cartesian_abstractions/abstract_state.h"
 #include "../cartesian_abstractions/cegar.h"
+#include "../cartesian_abstractions/compiled_refinement_hierarchy.h"
 #include "../cartesian_abstractions/cost_saturation.h"
 #include "../cartesian_abstractions/refinement_hierarchy.h"
 #include "../cartesian_abstractions/split_selector.h"
@@ -14,38 +17,74 @@
 #include "../cartesian_abstractions/utils.h"
 #include "../plugins/plugin.h"
 #include "../task_utils/task_properties.h"
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/parallel.h"
+#include "../utils/rng.h"
 #include "../utils/rng_options.h"
+#include "../utils/serialization.h"
+
+#include <atomic>
+#include <limits>
 
 using namespace std;
 
 namespace cost_saturation {
 class CartesianAbstractionFunction : public AbstractionFunction {
-    unique_ptr<cartesian_abstractions::RefinementHierarchy> refinement_hierarchy;
+    unique_ptr<cartesian_abstractions::CompiledRefinementHierarchy> refinement_hierarchy;
 
 public:
     explicit CartesianAbstractionFunction(
-        unique_ptr<cartesian_abstractions::RefinementHierarchy> refinement_hierarchy)
+        unique_ptr<cartesian_abstractions::CompiledRefinementHierarchy> refinement_hierarchy)
         : refinement_hierarchy(move(refinement_hierarchy)) {
     }
 
     virtual int get_abstract_state_id(const State &concrete_state) const override {
         return refinement_hierarchy->get_abstract_state_id(concrete_state);
     }
+
+    virtual void get_abstract_state_ids(
+        const vector<State> &states, vector<int> &state_ids) const override {
+        refinement_hierarchy->get_abstract_state_ids(states, state_ids);
+    }
+
+    virtual vector<int> get_variables() const override {
+        return refinement_hierarchy->get_variables();
+    }
+
+    virtual int get_num_states() const override {
+        return refinement_hierarchy->get_num_states();
+    }
+
+    virtual void save(ostream &os) const override {
+        utils::write_binary(os, AbstractionFunctionType::CARTESIAN);
+        refinement_hierarchy->save(os);
+    }
 };
 
+unique_ptr<AbstractionFunction> load_cartesian_abstraction_function(istream &is) {
+    return utils::make_unique_ptr<CartesianAbstractionFunction>(
+        utils::make_unique_ptr<cartesian_abstractions::CompiledRefinementHierarchy>(is));
+}
+
 
 static vector<bool> get_looping_operators(
-    const cartesian_abstractions::TransitionSystem &ts, const vector<int> &h_values) {
-    assert(ts.get_loops().size() == h_values.size());
+    const cartesian_abstractions::Abstraction &cartesian_abstraction,
+    const vector<int> &h_values) {
+    const cartesian_abstractions::TransitionSystem &ts =
+        cartesian_abstraction.get_transition_system();
+    assert(ts.get_num_states() == static_cast<int>(h_values.size()));
     int num_states = h_values.size();
     int num_operators = ts.get_num_operators();
     vector<bool> operator_induces_self_loop(num_operators, false);
     for (int state = 0; state < num_states; ++state) {
         // Ignore self-loops at unsolvable states.
         if (h_values[state] != INF) {
-            for (int op_id : ts.get_loops()[state]) {
-                operator_induces_self_loop[op_id] = true;
-            }
+            ts.for_each_loop(
+                cartesian_abstraction.get_state(state),
+                [&operator_induces_self_loop](int op_id) {
+                    operator_induces_self_loop[op_id] = true;
+                });
         }
     }
     return operator_induces_self_loop;
@@ -80,7 +119,7 @@ static pair<bool, unique_ptr<Abstraction>> convert_abstraction(
         backward_graph[target].shrink_to_fit();
     }
 
-    vector<bool> looping_operators = get_looping_operators(ts, h_values);
+    vector<bool> looping_operators = get_looping_operators(cartesian_abstraction, h_values);
     vector<int> goal_states(
         cartesian_abstraction.get_goals().begin(),
         cartesian_abstraction.get_goals().end());
@@ -90,7 +129,8 @@ static pair<bool, unique_ptr<Abstraction>> convert_abstraction(
         unsolvable,
         utils::make_unique_ptr<ExplicitAbstraction>(
             utils::make_unique_ptr<CartesianAbstractionFunction>(
-                cartesian_abstraction.extract_refinement_hierarchy()),
+                utils::make_unique_ptr<cartesian_abstractions::CompiledRefinementHierarchy>(
+                    *cartesian_abstraction.extract_refinement_hierarchy())),
             move(backward_graph),
             move(looping_operators),
             move(goal_states))
@@ -113,9 +153,12 @@ CartesianAbstractionGenerator::CartesianAbstractionGenerator(
       max_concrete_states_per_abstract_state(
           opts.get<int>("max_concrete_states_per_abstract_state")),
       max_state_expansions(opts.get<int>("max_state_expansions")),
+      flaw_search_threads(opts.get<int>("flaw_search_threads")),
+      store_loops(opts.get<bool>("store_loops")),
       extra_memory_padding_mb(opts.get<int>("memory_padding")),
       rng(utils::parse_rng_from_options(opts)),
       dot_graph_verbosity(opts.get<cartesian_abstractions::DotGraphVerbosity>("dot_graph_verbosity")),
+      num_threads(opts.get<int>("threads")),
       num_states(0),
       num_transitions(0) {
 }
@@ -142,6 +185,8 @@ unique_ptr<cartesian_abstractions::Abstraction> CartesianAbstractionGenerator::b
         tiebreak_split,
         max_concrete_states_per_abstract_state,
         max_state_expansions,
+        flaw_search_threads,
+        store_loops,
         *rng,
         log,
         dot_graph_verbosity);
@@ -153,6 +198,10 @@ void CartesianAbstractionGenerator::build_abstractions_for_subtasks(
     const vector<shared_ptr<AbstractTask>> &subtasks,
     const utils::CountdownTimer &timer,
     Abstractions &abstractions) {
+    if (num_threads > 1 && subtasks.size() > 1) {
+        build_abstractions_for_subtasks_in_parallel(subtasks, timer, abstractions);
+        return;
+    }
     log << "Build abstractions for " << subtasks.size() << " subtasks in "
         << timer.get_remaining_time() << endl;
     int remaining_subtasks = subtasks.size();
@@ -182,6 +231,128 @@ void CartesianAbstractionGenerator::build_abstractions_for_subtasks(
     }
 }
 
+struct SubtaskResult {
+    unique_ptr<Abstraction> abstraction;
+    bool unsolvable = false;
+    int num_states = 0;
+    int num_transitions = 0;
+};
+
+void CartesianAbstractionGenerator::build_abstractions_for_subtasks_in_parallel(
+    const vector<shared_ptr<AbstractTask>> &subtasks,
+    const utils::CountdownTimer &timer,
+    Abstractions &abstractions) {
+    int num_subtasks = subtasks.size();
+    int num_workers = min(num_threads, num_subtasks);
+    log << "Build abstractions for " << num_subtasks << " subtasks with "
+        << num_workers << " threads in " << timer.get_remaining_time() << endl;
+
+    vector<unique_ptr<utils::RandomNumberGenerator>> subtask_rngs;
+    subtask_rngs.reserve(num_subtasks);
+    for (const shared_ptr<AbstractTask> &subtask : subtasks) {
+        subtask_rngs.push_back(utils::make_unique_ptr<utils::RandomNumberGenerator>(
+                                   rng->random(numeric_limits<int>::max())));
+        /* Creating per-task information is not thread-safe, so we create the
+           entries that the flaw search needs before starting the threads. */
+        TaskProxy subtask_proxy(*subtask);
+        task_properties::g_state_packers[subtask_proxy];
+        g_axiom_evaluators[subtask_proxy];
+    }
+
+    /*
+      Each subtask gets an equal share of the remaining state and transition
+      budgets. Unlike in the sequential loop, subtasks can't use the budget
+      that earlier subtasks leave unused, since this would make the budgets
+      depend on the scheduling.
+    */
+    int state_budget = max(1, (max_states - num_states) / num_subtasks);
+    int transition_budget = max(1, (max_transitions - num_transitions) / num_subtasks);
+    atomic<int64_t> used_states(num_states);
+    atomic<int64_t> used_transitions(num_transitions);
+    atomic<int> next_subtask(0);
+    atomic<bool> stop(false);
+    vector<SubtaskResult> results(num_subtasks);
+    utils::run_in_parallel(num_workers, [&](int) {
+        // Log is not thread-safe, so the threads don't log.
+        utils::LogProxy silent_log = utils::get_silent_log();
+        while (!stop) {
+            int subtask_id = next_subtask++;
+            if (subtask_id >= num_subtasks) {
+                break;
+            }
+            int remaining_subtasks = num_subtasks - subtask_id;
+            /* Our timers measure the CPU time of the process, which advances
+               num_workers times faster than the wall clock while all threads
+               are busy. */
+            double remaining_time = timer.get_remaining_time();
+            double time_budget = min(
+                remaining_time, remaining_time * num_workers / remaining_subtasks);
+
+            cartesian_abstractions::CEGAR cegar(
+                subtasks[subtask_id],
+                state_budget,
+                transition_budget,
+                time_budget,
+                pick_flawed_abstract_state,
+                pick_split,
+                tiebreak_split,
+                max_concrete_states_per_abstract_state,
+                max_state_expansions,
+                flaw_search_threads,
+                store_loops,
+                *subtask_rngs[subtask_id],
+                silent_log,
+                dot_graph_verbosity);
+            unique_ptr<cartesian_abstractions::Abstraction> cartesian_abstraction =
+                cegar.extract_abstraction();
+
+            // See build_abstractions_for_subtasks().
+            if (!utils::extra_memory_padding_is_reserved()) {
+                stop = true;
+                break;
+            }
+
+            SubtaskResult &result = results[subtask_id];
+            result.num_states = cartesian_abstraction->get_num_states();
+            result.num_transitions =
+                cartesian_abstraction->get_transition_system().get_num_non_loops();
+            used_states += result.num_states;
+            used_transitions += result.num_transitions;
+
+            vector<int> operator_costs = task_properties::get_operator_costs(
+                TaskProxy(*subtasks[subtask_id]));
+            auto converted = convert_abstraction(*cartesian_abstraction, operator_costs);
+            result.unsolvable = converted.first;
+            result.abstraction = move(converted.second);
+
+            if (result.unsolvable ||
+                used_states >= max_states ||
+                used_transitions >= max_transitions ||
+                timer.is_expired() ||
+                !utils::extra_memory_padding_is_reserved()) {
+                stop = true;
+            }
+        }
+    });
+
+    for (int subtask_id = 0; subtask_id < num_subtasks; ++subtask_id) {
+        SubtaskResult &result = results[subtask_id];
+        // Skipped and discarded abstractions end the list, like in the sequential loop.
+        if (!result.abstraction) {
+            break;
+        }
+        log << "Subtask " << subtask_id << ": " << result.num_states
+            << " states, " << result.num_transitions << " transitions" << endl;
+        num_states += result.num_states;
+        num_transitions += result.num_transitions;
+        abstractions.push_back(move(result.abstraction));
+        // Like the sequential loop, we skip all abstractions after an unsolvable one.
+        if (result.unsolvable) {
+            break;
+        }
+    }
+}
+
 Abstractions CartesianAbstractionGenerator::generate_abstractions(
     const shared_ptr<AbstractTask> &task,
     DeadEnds *) {
@@ -221,6 +392,15 @@ public:
     CartesianAbstractionGeneratorFeature() : TypedFeature("cartesian") {
         document_title("Cartesian abstraction generator");
         cartesian_abstractions::add_common_cegar_options(*this);
+        add_option<int>(
+            "threads",
+            "number of threads for refining the abstractions of different "
+            "subtasks concurrently. With threads > 1, each subtask uses its own "
+            "random number generator, seeded from the random seed of this "
+            "generator. Note that max_time limits the CPU time of the whole "
+            "process.",
+            "1",
+            plugins::Bounds("1", "infinity"));
         utils::add_log_options_to_feature(*this);
     }
 };
@@ -3,6 +3,7 @@
 
 #include "abstraction_generator.h"
 
+#include <istream>
 #include <memory>
 #include <vector>
 
@@ -24,6 +25,12 @@ class RandomNumberGenerator;
 }
 
 namespace cost_saturation {
+class AbstractionFunction;
+
+// Read a function that has been written with save() (without the type tag).
+extern std::unique_ptr<AbstractionFunction> load_cartesian_abstraction_function(
+    std::istream &is);
+
 class CartesianAbstractionGenerator : public AbstractionGenerator {
     const std::vector<std::shared_ptr<cartesian_abstractions::SubtaskGenerator>> subtask_generators;
     const int max_states;
@@ -34,9 +41,12 @@ class CartesianAbstractionGenerator : public AbstractionGenerator {
     const cartesian_abstractions::PickSplit tiebreak_split;
     const int max_concrete_states_per_abstract_state;
     const int max_state_expansions;
+    const int flaw_search_threads;
+    const bool store_loops;
     const int extra_memory_padding_mb;
     const std::shared_ptr<utils::RandomNumberGenerator> rng;
     const cartesian_abstractions::DotGraphVerbosity dot_graph_verbosity;
+    const int num_threads;
 
     int num_states;
     int num_transitions;
@@ -53,6 +63,20 @@ class CartesianAbstractionGenerator : public AbstractionGenerator {
         const utils::CountdownTimer &timer,
         Abstractions &abstractions);
 
+    /*
+      Refine the abstractions for the subtasks concurrently. Each thread
+      repeatedly picks the next unprocessed subtask and builds its
+      abstraction with a separate CEGAR instance, logger and RNG. The RNGs
+      are seeded per subtask, the state and transition budgets are split
+      equally between the subtasks and the abstractions are appended in
+      subtask order, so the result doesn't depend on the scheduling unless
+      the time or memory limit is reached.
+    */
+    void build_abstractions_for_subtasks_in_parallel(
+        const std::vector<std::shared_ptr<AbstractTask>> &subtasks,
+        const utils::CountdownTimer &timer,
+        Abstractions &abstractions);
+
 public:
     explicit CartesianAbstractionGenerator(const plugins::Options &opts);
 
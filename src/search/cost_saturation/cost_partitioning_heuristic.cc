@@ -1,13 +1,77 @@
 #include "cost_partitioning_heuristic.h"
+
+#include "abstraction.h"
 #include "utils.h"
 
 #include "../utils/collections.h"
+#include "../utils/serialization.h"
 
 #include <cassert>
+#include <limits>
 
 using namespace std;
 
 namespace cost_saturation {
+template<typename T>
+static vector<T> narrow_h_values(const vector<int> &h_values) {
+    vector<T> narrow_h_values;
+    narrow_h_values.reserve(h_values.size());
+    for (int h : h_values) {
+        assert(h == INF || (h >= 0 && h < numeric_limits<T>::max()));
+        narrow_h_values.push_back(
+            (h == INF) ? numeric_limits<T>::max() : static_cast<T>(h));
+    }
+    return narrow_h_values;
+}
+
+int CostPartitioningHeuristic::LookupTable::get_num_states() const {
+    return h_values.size() + h_values_16.size() + h_values_8.size();
+}
+
+bool CostPartitioningHeuristic::LookupTable::is_compressed() const {
+    return !h_values_16.empty() || !h_values_8.empty();
+}
+
+void CostPartitioningHeuristic::LookupTable::compress() {
+    if (is_compressed()) {
+        return;
+    }
+    int max_finite_h = 0;
+    for (int h : h_values) {
+        if (h < 0) {
+            // Keep tables with negative values in the 32-bit representation.
+            return;
+        } else if (h != INF) {
+            max_finite_h = max(max_finite_h, h);
+        }
+    }
+    if (max_finite_h < numeric_limits<uint8_t>::max()) {
+        h_values_8 = narrow_h_values<uint8_t>(h_values);
+        utils::release_vector_memory(h_values);
+    } else if (max_finite_h < numeric_limits<uint16_t>::max()) {
+        h_values_16 = narrow_h_values<uint16_t>(h_values);
+        utils::release_vector_memory(h_values);
+    }
+}
+
+void CostPartitioningHeuristic::LookupTable::decompress() {
+    if (!is_compressed()) {
+        return;
+    }
+    int num_states = get_num_states();
+    h_values.reserve(num_states);
+    for (int state_id = 0; state_id < num_states; ++state_id) {
+        h_values.push_back(get_h(state_id));
+    }
+    utils::release_vector_memory(h_values_16);
+    utils::release_vector_memory(h_values_8);
+}
+
+size_t CostPartitioningHeuristic::LookupTable::estimate_size_in_bytes() const {
+    return h_values.size() * sizeof(int) + h_values_16.size() * sizeof(uint16_t) +
+           h_values_8.size() * sizeof(uint8_t) + sizeof(vector<int>);
+}
+
 int CostPartitioningHeuristic::get_lookup_table_index(int abstraction_id) const {
     for (size_t i = 0; i < lookup_tables.size(); ++i) {
         const LookupTable &table = lookup_tables[i];
@@ -34,7 +98,9 @@ void CostPartitioningHeuristic::merge_h_values(
             lookup_tables.emplace_back(abstraction_id, move(h_values));
         } else {
             // Sum values from old and new lookup table.
-            vector<int> &old_h_values = lookup_tables[lookup_table_id].h_values;
+            LookupTable &old_table = lookup_tables[lookup_table_id];
+            old_table.decompress();
+            vector<int> &old_h_values = old_table.h_values;
             assert(h_values.size() == old_h_values.size());
             for (size_t i = 0; i < h_values.size(); ++i) {
                 int &h1 = old_h_values[i];
@@ -47,6 +113,7 @@ void CostPartitioningHeuristic::merge_h_values(
 
 void CostPartitioningHeuristic::add(CostPartitioningHeuristic &&other) {
     for (LookupTable &table : other.lookup_tables) {
+        table.decompress();
         merge_h_values(table.abstraction_id, move(table.h_values));
     }
 }
@@ -63,8 +130,8 @@ int CostPartitioningHeuristic::compute_heuristic(
         [&abstract_state_ids](const LookupTable &lookup_table) {
             assert(utils::in_bounds(lookup_table.abstraction_id, abstract_state_ids));
             int state_id = abstract_state_ids[lookup_table.abstraction_id];
-            assert(utils::in_bounds(state_id, lookup_table.h_values));
-            return lookup_table.h_values[state_id];
+            assert(state_id >= 0 && state_id < lookup_table.get_num_states());
+            return lookup_table.get_h(state_id);
         });
 }
 
@@ -75,16 +142,30 @@ int CostPartitioningHeuristic::get_num_lookup_tables() const {
 int CostPartitioningHeuristic::get_num_heuristic_values() const {
     int num_values = 0;
     for (const auto &lookup_table : lookup_tables) {
-        num_values += lookup_table.h_values.size();
+        num_values += lookup_table.get_num_states();
     }
     return num_values;
 }
 
 int CostPartitioningHeuristic::estimate_size_in_kb() const {
+    size_t size_in_bytes = 0;
+    for (const auto &lookup_table : lookup_tables) {
+        size_in_bytes += lookup_table.estimate_size_in_bytes();
+    }
+    return size_in_bytes / 1024;
+}
+
+int CostPartitioningHeuristic::estimate_uncompressed_size_in_kb() const {
     return (get_num_heuristic_values() * sizeof(int) +
             lookup_tables.size() * sizeof(vector<int>)) / 1024;
 }
 
+void CostPartitioningHeuristic::compress() {
+    for (auto &lookup_table : lookup_tables) {
+        lookup_table.compress();
+    }
+}
+
 void CostPartitioningHeuristic::mark_useful_abstractions(
     vector<bool> &useful_abstractions) const {
     for (const auto &lookup_table : lookup_tables) {
@@ -92,4 +173,55 @@ void CostPartitioningHeuristic::mark_useful_abstractions(
         useful_abstractions[lookup_table.abstraction_id] = true;
     }
 }
+
+void CostPartitioningHeuristic::save(ostream &os) const {
+    utils::write_binary<int>(os, lookup_tables.size());
+    for (const LookupTable &lookup_table : lookup_tables) {
+        utils::write_binary(os, lookup_table.abstraction_id);
+        if (!lookup_table.h_values_8.empty()) {
+            utils::write_binary<uint8_t>(os, sizeof(uint8_t));
+            utils::write_binary_vector(os, lookup_table.h_values_8);
+        } else if (!lookup_table.h_values_16.empty()) {
+            utils::write_binary<uint8_t>(os, sizeof(uint16_t));
+            utils::write_binary_vector(os, lookup_table.h_values_16);
+        } else {
+            utils::write_binary<uint8_t>(os, sizeof(int));
+            utils::write_binary_vector(os, lookup_table.h_values);
+        }
+    }
+}
+
+void CostPartitioningHeuristic::load(istream &is) {
+    lookup_tables.clear();
+    int num_lookup_tables = utils::read_binary<int>(is);
+    for (int i = 0; i < num_lookup_tables && is; ++i) {
+        int abstraction_id = utils::read_binary<int>(is);
+        uint8_t bytes_per_value = utils::read_binary<uint8_t>(is);
+        if (bytes_per_value == sizeof(uint8_t)) {
+            lookup_tables.emplace_back(abstraction_id, vector<int>());
+            lookup_tables.back().h_values_8 = utils::read_binary_vector<uint8_t>(is);
+        } else if (bytes_per_value == sizeof(uint16_t)) {
+            lookup_tables.emplace_back(abstraction_id, vector<int>());
+            lookup_tables.back().h_values_16 = utils::read_binary_vector<uint16_t>(is);
+        } else if (bytes_per_value == sizeof(int)) {
+            lookup_tables.emplace_back(abstraction_id, utils::read_binary_vector<int>(is));
+        } else {
+            is.setstate(ios::failbit);
+        }
+    }
+}
+
+bool CostPartitioningHeuristic::fits(
+    const AbstractionFunctions &abstraction_functions) const {
+    for (const LookupTable &lookup_table : lookup_tables) {
+        int id = lookup_table.abstraction_id;
+        if (!utils::in_bounds(id, abstraction_functions) ||
+            !abstraction_functions[id] ||
+            lookup_table.get_num_states() !=
+            abstraction_functions[id]->get_num_states()) {
+            return false;
+        }
+    }
+    return true;
+}
 }
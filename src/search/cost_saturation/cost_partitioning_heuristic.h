@@ -3,6 +3,9 @@
 
 #include "types.h"
 
+#include <cstdint>
+#include <istream>
+#include <ostream>
 #include <vector>
 
 namespace cost_saturation {
@@ -16,21 +19,48 @@ namespace cost_saturation {
 
   We call the stored goal distances for an abstraction a lookup table.
   To save space, we only store lookup tables that contain positive estimates.
+  Calling compress() additionally stores each lookup table with the narrowest
+  unsigned integer type (8, 16 or 32 bits) that can represent all its finite
+  values. In the 8-bit and 16-bit representations, the largest representable
+  value encodes INF.
 */
 class CostPartitioningHeuristic {
     // Allow this class to extract and compress information about unsolvable states.
     friend class UnsolvabilityHeuristic;
+    // Allow this class to copy the lookup tables into one contiguous array.
+    friend class FlatLookupTables;
 
     struct LookupTable {
         int abstraction_id;
         /* h_values[i] is the goal distance of abstract state i under the cost
-           function assigned to the associated abstraction. */
+           function assigned to the associated abstraction. After compress(),
+           the values are stored in exactly one of the three vectors and the
+           others are empty. */
         std::vector<int> h_values;
+        std::vector<std::uint16_t> h_values_16;
+        std::vector<std::uint8_t> h_values_8;
 
         LookupTable(int abstraction_id, std::vector<int> &&h_values)
             : abstraction_id(abstraction_id),
               h_values(move(h_values)) {
         }
+
+        int get_h(int state_id) const {
+            if (!h_values_8.empty()) {
+                std::uint8_t h = h_values_8[state_id];
+                return (h == UINT8_MAX) ? INF : h;
+            } else if (!h_values_16.empty()) {
+                std::uint16_t h = h_values_16[state_id];
+                return (h == UINT16_MAX) ? INF : h;
+            }
+            return h_values[state_id];
+        }
+
+        int get_num_states() const;
+        bool is_compressed() const;
+        void compress();
+        void decompress();
+        std::size_t estimate_size_in_bytes() const;
     };
 
     std::vector<LookupTable> lookup_tables;
@@ -58,9 +88,21 @@ public:
     int get_num_heuristic_values() const;
 
     int estimate_size_in_kb() const;
+    // Return the size the lookup tables would need without compression.
+    int estimate_uncompressed_size_in_kb() const;
+
+    // Store each lookup table with the narrowest possible integer type.
+    void compress();
 
     // See class documentation.
     void mark_useful_abstractions(std::vector<bool> &useful_abstractions) const;
+
+    // Write the lookup tables to a binary stream and read them back.
+    void save(std::ostream &os) const;
+    void load(std::istream &is);
+    /* Check that each lookup table belongs to one of the given abstraction
+       functions and has one value per abstract state. */
+    bool fits(const AbstractionFunctions &abstraction_functions) const;
 };
 }
 
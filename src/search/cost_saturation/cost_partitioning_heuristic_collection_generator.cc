@@ -14,6 +14,8 @@
 #include "../utils/countdown_timer.h"
 #include "../utils/logging.h"
 #include "../utils/memory.h"
+#include "../utils/parallel.h"
+#include "../utils/rng.h"
 
 #include <cassert>
 
@@ -31,19 +33,28 @@ static vector<vector<int>> sample_states_and_return_abstract_state_ids(
     assert(num_samples >= 1);
     utils::CountdownTimer sampling_timer(max_sampling_time);
     utils::g_log << "Start sampling" << endl;
-    vector<vector<int>> abstract_state_ids_by_sample;
-    abstract_state_ids_by_sample.push_back(
-        get_abstract_state_ids(abstractions, task_proxy.get_initial_state()));
-    while (static_cast<int>(abstract_state_ids_by_sample.size()) < num_samples
+    vector<State> samples;
+    samples.push_back(task_proxy.get_initial_state());
+    while (static_cast<int>(samples.size()) < num_samples
            && !sampling_timer.is_expired()) {
-        abstract_state_ids_by_sample.push_back(
-            get_abstract_state_ids(abstractions, sampler.sample_state(init_h, is_dead_end)));
+        samples.push_back(sampler.sample_state(init_h, is_dead_end));
     }
+    vector<vector<int>> abstract_state_ids_by_sample =
+        get_abstract_state_ids(abstractions, samples);
     utils::g_log << "Samples: " << abstract_state_ids_by_sample.size() << endl;
     utils::g_log << "Sampling time: " << sampling_timer.get_elapsed_time() << endl;
     return abstract_state_ids_by_sample;
 }
 
+namespace {
+struct CandidateOrder {
+    Order order;
+    CostPartitioningHeuristic cp_heuristic;
+    // Heuristic values for the diversification samples.
+    vector<int> sample_h_values;
+};
+}
+
 
 CostPartitioningHeuristicCollectionGenerator::CostPartitioningHeuristicCollectionGenerator(
     const shared_ptr<OrderGenerator> &order_generator,
@@ -53,6 +64,8 @@ CostPartitioningHeuristicCollectionGenerator::CostPartitioningHeuristicCollectio
     bool diversify,
     int num_samples,
     double max_optimization_time,
+    int num_threads,
+    bool compress_lookup_tables,
     const shared_ptr<utils::RandomNumberGenerator> &rng)
     : order_generator(order_generator),
       max_orders(max_orders),
@@ -61,6 +74,8 @@ CostPartitioningHeuristicCollectionGenerator::CostPartitioningHeuristicCollectio
       diversify(diversify),
       num_samples(num_samples),
       max_optimization_time(max_optimization_time),
+      num_threads(num_threads),
+      compress_lookup_tables(compress_lookup_tables),
       rng(rng) {
     if (max_orders == INF && max_size_kb == INF && max_time == numeric_limits<double>::infinity()) {
         cerr << "max_orders, max_size and max_time cannot all be infinity" << endl;
@@ -86,7 +101,7 @@ CostPartitioningHeuristicCollectionGenerator::generate_cost_partitionings(
     Order order_for_init = order_generator->compute_order_for_state(
         abstract_state_ids_for_init, true);
     vector<int> remaining_costs = costs;
-    CostPartitioningHeuristic cp_for_init = cp_function(
+    CostPartitioningHeuristic cp_for_init = cp_function.compute(
         abstractions, order_for_init, remaining_costs, abstract_state_ids_for_init);
     int init_h = cp_for_init.compute_heuristic(abstract_state_ids_for_init);
 
@@ -112,62 +127,124 @@ CostPartitioningHeuristicCollectionGenerator::generate_cost_partitionings(
                 task_proxy, abstractions, sampler, num_samples, init_h, is_dead_end, max_sampling_time));
     }
 
-    log << "Start computing cost partitionings" << endl;
+    /*
+      With multiple threads, each thread samples states and computes orders
+      with its own RNG. We seed these RNGs deterministically and merge the
+      orders of each round in the order of the thread IDs, so the result only
+      depends on the random seed and the number of threads (and on timing if
+      max_time or max_optimization_time is reached).
+    */
+    vector<unique_ptr<utils::RandomNumberGenerator>> thread_rngs;
+    vector<unique_ptr<sampling::RandomWalkSampler>> thread_samplers;
+    if (num_threads > 1) {
+        for (int thread_id = 0; thread_id < num_threads; ++thread_id) {
+            thread_rngs.push_back(utils::make_unique_ptr<utils::RandomNumberGenerator>(
+                                      rng->random(numeric_limits<int>::max())));
+            thread_samplers.push_back(utils::make_unique_ptr<sampling::RandomWalkSampler>(
+                                          task_proxy, *thread_rngs.back()));
+        }
+    }
+
+    /*
+      Our timers measure the CPU time of the process, which advances
+      num_threads times faster than the wall clock while all threads are busy.
+      We therefore scale the time limits for the parallel computation by the
+      number of threads. With one thread, this changes nothing.
+    */
+    utils::CountdownTimer orders_timer(timer.get_remaining_time() * num_threads);
+    double max_optimization_cpu_time = max_optimization_time * num_threads;
+
+    log << "Start computing cost partitionings";
+    if (num_threads > 1) {
+        log << " with " << num_threads << " threads";
+    }
+    log << endl;
     vector<CostPartitioningHeuristic> cp_heuristics;
     int evaluated_orders = 0;
     int size_kb = 0;
+    int uncompressed_size_kb = 0;
+    vector<CandidateOrder> candidates(num_threads);
     while (static_cast<int>(cp_heuristics.size()) < max_orders &&
-           (!timer.is_expired() || cp_heuristics.empty()) &&
+           (!orders_timer.is_expired() || cp_heuristics.empty()) &&
            (size_kb < max_size_kb)) {
-        bool is_first_order = (evaluated_orders == 0);
-
-        vector<int> abstract_state_ids;
-        Order order;
-        CostPartitioningHeuristic cp_heuristic;
-        if (is_first_order) {
-            // Use initial state as first sample.
-            abstract_state_ids = abstract_state_ids_for_init;
-            order = order_for_init;
-            cp_heuristic = cp_for_init;
-        } else {
-            abstract_state_ids = get_abstract_state_ids(
-                abstractions, sampler.sample_state(init_h, is_dead_end));
-            order = order_generator->compute_order_for_state(
-                abstract_state_ids, false);
-            remaining_costs = costs;
-            cp_heuristic = cp_function(abstractions, order, remaining_costs, abstract_state_ids);
-        }
+        utils::run_in_parallel(num_threads, [&](int thread_id) {
+            CandidateOrder &candidate = candidates[thread_id];
+            bool is_first_order = (evaluated_orders == 0 && thread_id == 0);
 
-        // Optimize order.
-        double optimization_time = min(
-            static_cast<double>(timer.get_remaining_time()), max_optimization_time);
-        if (optimization_time > 0) {
-            utils::CountdownTimer opt_timer(optimization_time);
-            int incumbent_h_value = cp_heuristic.compute_heuristic(abstract_state_ids);
-            optimize_order_with_hill_climbing(
-                cp_function, opt_timer, abstractions, costs, abstract_state_ids, order,
-                cp_heuristic, incumbent_h_value, is_first_order);
+            vector<int> abstract_state_ids;
             if (is_first_order) {
-                log << "Time for optimizing order: " << opt_timer.get_elapsed_time()
-                    << endl;
+                // Use initial state as first sample.
+                abstract_state_ids = abstract_state_ids_for_init;
+                candidate.order = order_for_init;
+                candidate.cp_heuristic = cp_for_init;
+            } else {
+                if (num_threads == 1) {
+                    abstract_state_ids = get_abstract_state_ids(
+                        abstractions, sampler.sample_state(init_h, is_dead_end));
+                    candidate.order = order_generator->compute_order_for_state(
+                        abstract_state_ids, false);
+                } else {
+                    abstract_state_ids = get_abstract_state_ids(
+                        abstractions,
+                        thread_samplers[thread_id]->sample_state(init_h, is_dead_end));
+                    candidate.order = order_generator->compute_order_for_state(
+                        abstract_state_ids, *thread_rngs[thread_id], false);
+                }
+                vector<int> remaining_costs = costs;
+                candidate.cp_heuristic = cp_function.compute(
+                    abstractions, candidate.order, remaining_costs, abstract_state_ids);
+            }
+
+            // Optimize order.
+            double optimization_time = min(
+                static_cast<double>(orders_timer.get_remaining_time()),
+                max_optimization_cpu_time);
+            if (optimization_time > 0) {
+                utils::CountdownTimer opt_timer(optimization_time);
+                int incumbent_h_value = candidate.cp_heuristic.compute_heuristic(
+                    abstract_state_ids);
+                optimize_order_with_hill_climbing(
+                    cp_function, opt_timer, abstractions, costs,
+                    abstract_state_ids, candidate.order, candidate.cp_heuristic, incumbent_h_value,
+                    is_first_order);
+                if (is_first_order) {
+                    log << "Time for optimizing order: " << opt_timer.get_elapsed_time()
+                        << endl;
+                }
             }
-        }
 
-        // If diversify=true, only add order if it improves upon previously
-        // added orders.
-        if (!diversifier || diversifier->is_diverse(cp_heuristic)) {
-            size_kb += cp_heuristic.estimate_size_in_kb();
-            cp_heuristics.push_back(move(cp_heuristic));
             if (diversifier) {
-                log << "Average finite h-value for " << num_samples
-                    << " samples after " << timer.get_elapsed_time()
-                    << " of diversification: "
-                    << diversifier->compute_avg_finite_sample_h_value()
-                    << endl;
+                candidate.sample_h_values =
+                    diversifier->compute_sample_h_values(candidate.cp_heuristic);
             }
-        }
 
-        ++evaluated_orders;
+            if (compress_lookup_tables) {
+                candidate.cp_heuristic.compress();
+            }
+        });
+
+        for (CandidateOrder &candidate : candidates) {
+            if (static_cast<int>(cp_heuristics.size()) >= max_orders ||
+                size_kb >= max_size_kb) {
+                break;
+            }
+            // If diversify=true, only add order if it improves upon previously
+            // added orders.
+            if (!diversifier || diversifier->is_diverse(candidate.sample_h_values)) {
+                size_kb += candidate.cp_heuristic.estimate_size_in_kb();
+                uncompressed_size_kb +=
+                    candidate.cp_heuristic.estimate_uncompressed_size_in_kb();
+                cp_heuristics.push_back(move(candidate.cp_heuristic));
+                if (diversifier) {
+                    log << "Average finite h-value for " << num_samples
+                        << " samples after " << timer.get_elapsed_time()
+                        << " of diversification: "
+                        << diversifier->compute_avg_finite_sample_h_value()
+                        << endl;
+                }
+            }
+            ++evaluated_orders;
+        }
     }
 
     log << "Evaluated orders: " << evaluated_orders << endl;
@@ -175,6 +252,10 @@ CostPartitioningHeuristicCollectionGenerator::generate_cost_partitionings(
     log << "Time for computing cost partitionings: " << timer.get_elapsed_time()
         << endl;
     log << "Estimated heuristic size: " << size_kb << " KiB" << endl;
+    if (compress_lookup_tables) {
+        log << "Estimated heuristic size without compression: "
+            << uncompressed_size_kb << " KiB" << endl;
+    }
     return cp_heuristics;
 }
 }
@@ -24,6 +24,8 @@ class CostPartitioningHeuristicCollectionGenerator {
     const bool diversify;
     const int num_samples;
     const double max_optimization_time;
+    const int num_threads;
+    const bool compress_lookup_tables;
     const std::shared_ptr<utils::RandomNumberGenerator> rng;
 
 public:
@@ -35,6 +37,8 @@ public:
         bool diversify,
         int num_samples,
         double max_optimization_time,
+        int num_threads,
+        bool compress_lookup_tables,
         const std::shared_ptr<utils::RandomNumberGenerator> &rng);
 
     std::vector<CostPartitioningHeuristic> generate_cost_partitionings(
@@ -17,11 +17,15 @@ Diversifier::Diversifier(vector<vector<int>> &&abstract_state_ids_by_sample)
 }
 
 bool Diversifier::is_diverse(const CostPartitioningHeuristic &cp_heuristic) {
+    return is_diverse(compute_sample_h_values(cp_heuristic));
+}
+
+bool Diversifier::is_diverse(const vector<int> &sample_h_values) {
+    assert(sample_h_values.size() == portfolio_h_values.size());
     bool cp_improves_portfolio = false;
     int num_samples = abstract_state_ids_by_sample.size();
     for (int sample_id = 0; sample_id < num_samples; ++sample_id) {
-        int cp_h_value = cp_heuristic.compute_heuristic(
-            abstract_state_ids_by_sample[sample_id]);
+        int cp_h_value = sample_h_values[sample_id];
         assert(utils::in_bounds(sample_id, portfolio_h_values));
         int &portfolio_h_value = portfolio_h_values[sample_id];
         if (cp_h_value > portfolio_h_value) {
@@ -32,6 +36,16 @@ bool Diversifier::is_diverse(const CostPartitioningHeuristic &cp_heuristic) {
     return cp_improves_portfolio;
 }
 
+vector<int> Diversifier::compute_sample_h_values(
+    const CostPartitioningHeuristic &cp_heuristic) const {
+    vector<int> sample_h_values;
+    sample_h_values.reserve(abstract_state_ids_by_sample.size());
+    for (const vector<int> &abstract_state_ids : abstract_state_ids_by_sample) {
+        sample_h_values.push_back(cp_heuristic.compute_heuristic(abstract_state_ids));
+    }
+    return sample_h_values;
+}
+
 float Diversifier::compute_avg_finite_sample_h_value() const {
     float sum_h = 0;
     int num_finite_values = 0;
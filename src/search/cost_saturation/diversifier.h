@@ -17,6 +17,14 @@ public:
        value than all previously seen heuristics for at least one sample. */
     bool is_diverse(const CostPartitioningHeuristic &cp_heuristic);
 
+    /* Same as above, but for heuristic values that have been computed with
+       compute_sample_h_values(). */
+    bool is_diverse(const std::vector<int> &sample_h_values);
+
+    // Return the heuristic values of the given heuristic for all samples.
+    std::vector<int> compute_sample_h_values(
+        const CostPartitioningHeuristic &cp_heuristic) const;
+
     float compute_avg_finite_sample_h_value() const;
 };
 }
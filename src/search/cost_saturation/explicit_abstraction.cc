@@ -2,6 +2,7 @@
 
 #include "types.h"
 
+#include "../algorithms/priority_queues.h"
 #include "../utils/collections.h"
 #include "../utils/logging.h"
 #include "../utils/strings.h"
@@ -12,7 +13,9 @@ using namespace std;
 
 namespace cost_saturation {
 static void dijkstra_search(
-    const vector<vector<Successor>> &graph,
+    const vector<int> &edge_offsets,
+    const vector<int> &edge_ops,
+    const vector<int> &edge_states,
     const vector<int> &costs,
     priority_queues::AdaptiveQueue<int> &queue,
     vector<int> &distances) {
@@ -26,9 +29,10 @@ static void dijkstra_search(
         if (state_distance < distance) {
             continue;
         }
-        for (const Successor &transition : graph[state]) {
-            int successor = transition.state;
-            int op = transition.op;
+        int end = edge_offsets[state + 1];
+        for (int i = edge_offsets[state]; i < end; ++i) {
+            int successor = edge_states[i];
+            int op = edge_ops[i];
             assert(utils::in_bounds(op, costs));
             int cost = costs[op];
             assert(cost >= 0);
@@ -47,51 +51,57 @@ ostream &operator<<(ostream &os, const Successor &successor) {
     return os;
 }
 
-static vector<bool> get_active_operators_from_graph(
-    const vector<vector<Successor>> &backward_graph, int num_ops) {
-    vector<bool> active_operators(num_ops, false);
-    int num_states = backward_graph.size();
-    for (int target = 0; target < num_states; ++target) {
-        for (const Successor &transition : backward_graph[target]) {
-            int op_id = transition.op;
-            active_operators[op_id] = true;
-        }
-    }
-    return active_operators;
-}
-
 ExplicitAbstraction::ExplicitAbstraction(
     unique_ptr<AbstractionFunction> abstraction_function,
-    vector<vector<Successor>> &&backward_graph_,
+    vector<vector<Successor>> &&backward_graph,
     vector<bool> &&looping_operators,
     vector<int> &&goal_states)
     : Abstraction(move(abstraction_function)),
-      backward_graph(move(backward_graph_)),
-      active_operators(get_active_operators_from_graph(
-                           backward_graph, looping_operators.size())),
+      active_operators(looping_operators.size(), false),
       looping_operators(move(looping_operators)),
       goal_states(move(goal_states)) {
+    int num_states = backward_graph.size();
+    int num_transitions = 0;
+    for (const vector<Successor> &transitions : backward_graph) {
+        num_transitions += transitions.size();
+    }
+    backward_edge_offsets.reserve(num_states + 1);
+    backward_edge_ops.reserve(num_transitions);
+    backward_edge_sources.reserve(num_transitions);
+    backward_edge_offsets.push_back(0);
+    for (int target = 0; target < num_states; ++target) {
 #ifndef NDEBUG
-    for (int target = 0; target < get_num_states(); ++target) {
         // Check that no transition is stored multiple times.
-        vector<Successor> copied_transitions = this->backward_graph[target];
+        vector<Successor> copied_transitions = backward_graph[target];
         sort(copied_transitions.begin(), copied_transitions.end());
         assert(utils::is_sorted_unique(copied_transitions));
         // Check that we don't store self-loops.
         assert(all_of(copied_transitions.begin(), copied_transitions.end(),
                       [target](const Successor &succ) {return succ.state != target;}));
-    }
 #endif
+        for (const Successor &transition : backward_graph[target]) {
+            backward_edge_ops.push_back(transition.op);
+            backward_edge_sources.push_back(transition.state);
+            active_operators[transition.op] = true;
+        }
+        backward_edge_offsets.push_back(backward_edge_ops.size());
+        // Release memory early.
+        vector<Successor>().swap(backward_graph[target]);
+    }
 }
 
 vector<int> ExplicitAbstraction::compute_goal_distances(const vector<int> &costs) const {
     vector<int> goal_distances(get_num_states(), INF);
+    // Reuse the queue to save allocations, but use one queue per thread.
+    static thread_local priority_queues::AdaptiveQueue<int> queue;
     queue.clear();
     for (int goal_state : goal_states) {
         goal_distances[goal_state] = 0;
         queue.push(0, goal_state);
     }
-    dijkstra_search(backward_graph, costs, queue, goal_distances);
+    dijkstra_search(
+        backward_edge_offsets, backward_edge_ops, backward_edge_sources,
+        costs, queue, goal_distances);
     return goal_distances;
 }
 
@@ -108,7 +118,7 @@ vector<int> ExplicitAbstraction::compute_saturated_costs(
         }
     }
 
-    int num_states = backward_graph.size();
+    int num_states = get_num_states();
     for (int target = 0; target < num_states; ++target) {
         assert(utils::in_bounds(target, h_values));
         int target_h = h_values[target];
@@ -116,17 +126,15 @@ vector<int> ExplicitAbstraction::compute_saturated_costs(
             continue;
         }
 
-        for (const Successor &transition : backward_graph[target]) {
-            int op_id = transition.op;
-            int src = transition.state;
-            assert(utils::in_bounds(src, h_values));
-            int src_h = h_values[src];
-            if (src_h == INF) {
-                continue;
-            }
-
-            const int needed = src_h - target_h;
-            saturated_costs[op_id] = max(saturated_costs[op_id], needed);
+        /* The inner loop runs over contiguous arrays and has no branches
+           besides the loop condition, so the compiler can unroll it and
+           use conditional moves. */
+        int end = backward_edge_offsets[target + 1];
+        for (int i = backward_edge_offsets[target]; i < end; ++i) {
+            int src_h = h_values[backward_edge_sources[i]];
+            int needed = (src_h == INF) ? -INF : src_h - target_h;
+            int &saturated_cost = saturated_costs[backward_edge_ops[i]];
+            saturated_cost = max(saturated_cost, needed);
         }
     }
     return saturated_costs;
@@ -137,7 +145,7 @@ int ExplicitAbstraction::get_num_operators() const {
 }
 
 int ExplicitAbstraction::get_num_states() const {
-    return backward_graph.size();
+    return backward_edge_offsets.size() - 1;
 }
 
 bool ExplicitAbstraction::operator_is_active(int op_id) const {
@@ -151,10 +159,9 @@ bool ExplicitAbstraction::operator_induces_self_loop(int op_id) const {
 void ExplicitAbstraction::for_each_transition(const TransitionCallback &callback) const {
     int num_states = get_num_states();
     for (int target = 0; target < num_states; ++target) {
-        for (const Successor &transition : backward_graph[target]) {
-            int op_id = transition.op;
-            int src = transition.state;
-            callback(Transition(src, op_id, target));
+        for (int i = backward_edge_offsets[target];
+             i < backward_edge_offsets[target + 1]; ++i) {
+            callback(Transition(backward_edge_sources[i], backward_edge_ops[i], target));
         }
     }
 }
@@ -186,9 +193,10 @@ void ExplicitAbstraction::dump() const {
     }
     for (int target = 0; target < num_states; ++target) {
         unordered_map<int, vector<int>> parallel_transitions;
-        for (const Successor &succ : backward_graph[target]) {
-            int src = succ.state;
-            parallel_transitions[src].push_back(succ.op);
+        for (int i = backward_edge_offsets[target];
+             i < backward_edge_offsets[target + 1]; ++i) {
+            parallel_transitions[backward_edge_sources[i]].push_back(
+                backward_edge_ops[i]);
         }
         for (const auto &pair : parallel_transitions) {
             int src = pair.first;
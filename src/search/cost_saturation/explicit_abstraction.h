@@ -3,8 +3,6 @@
 
 #include "abstraction.h"
 
-#include "../algorithms/priority_queues.h"
-
 #include <memory>
 #include <utility>
 #include <vector>
@@ -32,8 +30,15 @@ std::ostream &operator<<(std::ostream &os, const Successor &successor);
 
 
 class ExplicitAbstraction : public Abstraction {
-    // State-changing transitions.
-    std::vector<std::vector<Successor>> backward_graph;
+    /*
+      State-changing transitions, grouped by target state in compressed
+      sparse row format: the transitions into state s are stored at indices
+      [backward_edge_offsets[s], backward_edge_offsets[s+1]) of the
+      backward_edge_ops and backward_edge_sources arrays.
+    */
+    std::vector<int> backward_edge_offsets;
+    std::vector<int> backward_edge_ops;
+    std::vector<int> backward_edge_sources;
 
     // Operators inducing state-changing transitions.
     std::vector<bool> active_operators;
@@ -43,8 +48,6 @@ class ExplicitAbstraction : public Abstraction {
 
     std::vector<int> goal_states;
 
-    mutable priority_queues::AdaptiveQueue<int> queue;
-
 public:
     ExplicitAbstraction(
         std::unique_ptr<AbstractionFunction> abstraction_function,
@@ -0,0 +1,182 @@
+#include "explicit_abstraction_benchmark.h"
+
+#include "abstraction.h"
+#include "abstraction_generator.h"
+#include "explicit_abstraction.h"
+#include "types.h"
+#include "utils.h"
+
+#include "../algorithms/priority_queues.h"
+#include "../plugins/plugin.h"
+#include "../task_utils/task_properties.h"
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/timer.h"
+
+using namespace std;
+
+namespace cost_saturation {
+/*
+  Transition system that stores the incoming transitions of each state in a
+  separate vector. This was the representation of ExplicitAbstraction before
+  we switched to compressed sparse rows.
+*/
+class ReferenceExplicitAbstraction {
+    vector<vector<Successor>> backward_graph;
+    vector<bool> looping_operators;
+    vector<int> goal_states;
+
+public:
+    explicit ReferenceExplicitAbstraction(const Abstraction &abstraction)
+        : backward_graph(abstraction.get_num_states()),
+          goal_states(abstraction.get_goal_states()) {
+        abstraction.for_each_transition(
+            [this](const Transition &t) {
+                backward_graph[t.target].emplace_back(t.op, t.src);
+            });
+        int num_operators = abstraction.get_num_operators();
+        looping_operators.resize(num_operators);
+        for (int op_id = 0; op_id < num_operators; ++op_id) {
+            looping_operators[op_id] = abstraction.operator_induces_self_loop(op_id);
+        }
+    }
+
+    vector<int> compute_goal_distances(const vector<int> &costs) const {
+        vector<int> distances(backward_graph.size(), INF);
+        priority_queues::AdaptiveQueue<int> queue;
+        for (int goal_state : goal_states) {
+            distances[goal_state] = 0;
+            queue.push(0, goal_state);
+        }
+        while (!queue.empty()) {
+            pair<int, int> top_pair = queue.pop();
+            int distance = top_pair.first;
+            int state = top_pair.second;
+            int state_distance = distances[state];
+            if (state_distance < distance) {
+                continue;
+            }
+            for (const Successor &transition : backward_graph[state]) {
+                int cost = costs[transition.op];
+                int successor_distance = (cost == INF) ? INF : state_distance + cost;
+                if (distances[transition.state] > successor_distance) {
+                    distances[transition.state] = successor_distance;
+                    queue.push(successor_distance, transition.state);
+                }
+            }
+        }
+        return distances;
+    }
+
+    vector<int> compute_saturated_costs(const vector<int> &h_values) const {
+        int num_operators = looping_operators.size();
+        vector<int> saturated_costs(num_operators, -INF);
+        for (int op_id = 0; op_id < num_operators; ++op_id) {
+            if (looping_operators[op_id]) {
+                saturated_costs[op_id] = 0;
+            }
+        }
+        int num_states = backward_graph.size();
+        for (int target = 0; target < num_states; ++target) {
+            int target_h = h_values[target];
+            if (target_h == INF) {
+                continue;
+            }
+            for (const Successor &transition : backward_graph[target]) {
+                int src_h = h_values[transition.state];
+                if (src_h == INF) {
+                    continue;
+                }
+                saturated_costs[transition.op] = max(
+                    saturated_costs[transition.op], src_h - target_h);
+            }
+        }
+        return saturated_costs;
+    }
+};
+
+/*
+  Run saturated cost partitioning over all abstractions in the default order
+  and return the concatenated goal distances and saturated cost functions.
+*/
+template<typename AbstractionList>
+static vector<int> run_saturated_cost_partitioning(
+    const AbstractionList &abstractions, const vector<int> &costs) {
+    vector<int> values;
+    vector<int> remaining_costs = costs;
+    for (const auto &abstraction : abstractions) {
+        vector<int> h_values = abstraction->compute_goal_distances(remaining_costs);
+        vector<int> saturated_costs = abstraction->compute_saturated_costs(h_values);
+        reduce_costs(remaining_costs, saturated_costs);
+        values.insert(values.end(), h_values.begin(), h_values.end());
+        values.insert(values.end(), saturated_costs.begin(), saturated_costs.end());
+    }
+    return values;
+}
+
+ExplicitAbstractionBenchmark::ExplicitAbstractionBenchmark(const plugins::Options &opts)
+    : Benchmark(opts, "explicit abstractions"),
+      abstraction_generators(
+          opts.get_list<shared_ptr<AbstractionGenerator>>("abstractions")),
+      repetitions(opts.get<int>("repetitions")) {
+}
+
+void ExplicitAbstractionBenchmark::run_benchmark() {
+    Abstractions abstractions = generate_abstractions(task, abstraction_generators);
+    vector<unique_ptr<ReferenceExplicitAbstraction>> reference_abstractions;
+    int num_transitions = 0;
+    for (const auto &abstraction : abstractions) {
+        reference_abstractions.push_back(
+            utils::make_unique_ptr<ReferenceExplicitAbstraction>(*abstraction));
+        abstraction->for_each_transition(
+            [&num_transitions](const Transition &) {++num_transitions;});
+    }
+    log << "Transitions: " << num_transitions << endl;
+
+    vector<int> costs = task_properties::get_operator_costs(task_proxy);
+
+    utils::Timer reference_timer;
+    vector<int> reference_values;
+    for (int i = 0; i < repetitions; ++i) {
+        reference_values = run_saturated_cost_partitioning(reference_abstractions, costs);
+    }
+    reference_timer.stop();
+
+    utils::Timer timer;
+    vector<int> values;
+    for (int i = 0; i < repetitions; ++i) {
+        values = run_saturated_cost_partitioning(abstractions, costs);
+    }
+    timer.stop();
+
+    check(values == reference_values,
+          "Explicit abstractions computed different values.");
+    log << "Saturated cost partitioning: reference abstractions "
+        << reference_timer << ", explicit abstractions " << timer << endl;
+}
+
+class ExplicitAbstractionBenchmarkFeature
+    : public plugins::TypedFeature<SearchAlgorithm, ExplicitAbstractionBenchmark> {
+public:
+    ExplicitAbstractionBenchmarkFeature() : TypedFeature("explicit_abstraction_benchmark") {
+        document_title("Explicit abstraction benchmark");
+        document_synopsis(
+            "Measures how long ExplicitAbstraction and a reference "
+            "implementation that stores one transition vector per abstract "
+            "state need for computing saturated cost partitionings.");
+
+        add_list_option<shared_ptr<AbstractionGenerator>>(
+            "abstractions",
+            "abstraction generators",
+            "[cartesian()]");
+        add_option<int>(
+            "repetitions",
+            "number of saturated cost partitionings to compute",
+            "100",
+            plugins::Bounds("1", "infinity"));
+        benchmark::add_benchmark_options_to_feature(*this);
+    }
+};
+
+static plugins::FeaturePlugin<ExplicitAbstractionBenchmarkFeature> _plugin;
+}
@@ -0,0 +1,34 @@
+#ifndef COST_SATURATION_EXPLICIT_ABSTRACTION_BENCHMARK_H
+#define COST_SATURATION_EXPLICIT_ABSTRACTION_BENCHMARK_H
+
+#include "../search_algorithms/benchmark.h"
+
+#include <memory>
+#include <vector>
+
+namespace cost_saturation {
+class AbstractionGenerator;
+
+/*
+  Compare the running time of ExplicitAbstraction, which stores its
+  transitions in compressed sparse row format, with a reference
+  implementation that stores one vector of transitions per abstract state.
+
+  We compute the given abstractions and then run saturated cost
+  partitioning in the default order for the given number of repetitions,
+  i.e., we alternately compute goal distances and saturated costs. The
+  benchmark checks that both implementations compute the same values.
+*/
+class ExplicitAbstractionBenchmark : public benchmark::Benchmark {
+    const std::vector<std::shared_ptr<AbstractionGenerator>> abstraction_generators;
+    const int repetitions;
+
+protected:
+    virtual void run_benchmark() override;
+
+public:
+    explicit ExplicitAbstractionBenchmark(const plugins::Options &opts);
+};
+}
+
+#endif
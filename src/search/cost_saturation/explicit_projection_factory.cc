@@ -278,7 +278,8 @@ bool ExplicitProjectionFactory::is_goal_state(
 
 unique_ptr<Abstraction> ExplicitProjectionFactory::convert_to_abstraction() {
     return utils::make_unique_ptr<ExplicitAbstraction>(
-        utils::make_unique_ptr<ProjectionFunction>(pattern, move(hash_multipliers)),
+        utils::make_unique_ptr<ProjectionFunction>(
+            pattern, move(hash_multipliers), num_states),
         move(backward_graph),
         move(looping_operators),
         move(goal_states));
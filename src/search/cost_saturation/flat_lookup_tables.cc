@@ -0,0 +1,142 @@
+#include "flat_lookup_tables.h"
+
+#include "cost_partitioning_heuristic.h"
+
+#include "../utils/system.h"
+
+#include <cassert>
+#include <iostream>
+#include <limits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define COST_SATURATION_USE_AVX2_GATHER
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace cost_saturation {
+static void gather_h_values_scalar(
+    const int *h_values, const int *abstraction_ids, const int *offsets,
+    const int *abstract_state_ids, int *result, int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        result[i] = h_values[offsets[i] + abstract_state_ids[abstraction_ids[i]]];
+    }
+}
+
+#ifdef COST_SATURATION_USE_AVX2_GATHER
+__attribute__((target("avx2")))
+static void gather_h_values_avx2(
+    const int *h_values, const int *abstraction_ids, const int *offsets,
+    const int *abstract_state_ids, int *result, int num_tables) {
+    int i = 0;
+    for (; i + 8 <= num_tables; i += 8) {
+        __m256i ids = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(abstraction_ids + i));
+        __m256i state_ids = _mm256_i32gather_epi32(abstract_state_ids, ids, 4);
+        __m256i table_offsets = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(offsets + i));
+        __m256i indices = _mm256_add_epi32(table_offsets, state_ids);
+        __m256i h = _mm256_i32gather_epi32(h_values, indices, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), h);
+    }
+    gather_h_values_scalar(
+        h_values, abstraction_ids, offsets, abstract_state_ids, result, i, num_tables);
+}
+
+static bool cpu_supports_avx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+FlatLookupTables::FlatLookupTables(const CPHeuristics &cp_heuristics) {
+    int num_tables = 0;
+    size_t num_values = 0;
+    for (const CostPartitioningHeuristic &cp_heuristic : cp_heuristics) {
+        for (const auto &table : cp_heuristic.lookup_tables) {
+            ++num_tables;
+            num_values += table.get_num_states();
+        }
+    }
+    // Gather instructions use signed 32-bit indices.
+    if (num_values > static_cast<size_t>(numeric_limits<int>::max())) {
+        cerr << "Too many h values for flat lookup tables: " << num_values << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+    }
+
+    h_values.reserve(num_values);
+    table_abstraction_ids.reserve(num_tables);
+    table_offsets.reserve(num_tables);
+    order_ends.reserve(cp_heuristics.size());
+    for (const CostPartitioningHeuristic &cp_heuristic : cp_heuristics) {
+        for (const auto &table : cp_heuristic.lookup_tables) {
+            table_abstraction_ids.push_back(table.abstraction_id);
+            table_offsets.push_back(h_values.size());
+            int num_states = table.get_num_states();
+            for (int state_id = 0; state_id < num_states; ++state_id) {
+                h_values.push_back(table.get_h(state_id));
+            }
+        }
+        order_ends.push_back(table_abstraction_ids.size());
+    }
+    gathered_h_values.resize(num_tables);
+}
+
+void FlatLookupTables::gather_h_values(const vector<int> &abstract_state_ids) const {
+    int num_tables = table_abstraction_ids.size();
+#ifdef COST_SATURATION_USE_AVX2_GATHER
+    if (cpu_supports_avx2()) {
+        gather_h_values_avx2(
+            h_values.data(), table_abstraction_ids.data(), table_offsets.data(),
+            abstract_state_ids.data(), gathered_h_values.data(), num_tables);
+        return;
+    }
+#endif
+    gather_h_values_scalar(
+        h_values.data(), table_abstraction_ids.data(), table_offsets.data(),
+        abstract_state_ids.data(), gathered_h_values.data(), 0, num_tables);
+}
+
+int FlatLookupTables::compute_max_h(
+    const vector<int> &abstract_state_ids, vector<int> *num_best_order) const {
+    gather_h_values(abstract_state_ids);
+
+    int max_h = 0;
+    int best_id = -1;
+    int begin = 0;
+    int num_orders = order_ends.size();
+    for (int order_id = 0; order_id < num_orders; ++order_id) {
+        int end = order_ends[order_id];
+        int sum_h = 0;
+        for (int i = begin; i < end; ++i) {
+            assert(gathered_h_values[i] != INF);
+            sum_h += gathered_h_values[i];
+        }
+        if (sum_h > max_h) {
+            max_h = sum_h;
+            best_id = order_id;
+        }
+        begin = end;
+    }
+    assert(max_h >= 0);
+
+    if (num_best_order) {
+        num_best_order->resize(num_orders, 0);
+        if (best_id != -1) {
+            ++(*num_best_order)[best_id];
+        }
+    }
+
+    return max_h;
+}
+
+int FlatLookupTables::get_num_orders() const {
+    return order_ends.size();
+}
+
+int FlatLookupTables::estimate_size_in_kb() const {
+    return ((h_values.size() + table_abstraction_ids.size() + table_offsets.size() +
+             order_ends.size() + gathered_h_values.size()) * sizeof(int)) / 1024;
+}
+}
@@ -0,0 +1,48 @@
+#ifndef COST_SATURATION_FLAT_LOOKUP_TABLES_H
+#define COST_SATURATION_FLAT_LOOKUP_TABLES_H
+
+#include "types.h"
+
+#include <vector>
+
+namespace cost_saturation {
+/*
+  Store the lookup tables of all cost partitioning heuristics (orders) in a
+  single contiguous array and compute the maximum over all orders in one
+  pass.
+
+  For each lookup table, we store the ID of its abstraction and the offset of
+  its first h value in the shared array. The tables of order i are the tables
+  in the range [order_ends[i - 1], order_ends[i]). Evaluating a state consists
+  of two flat loops: one that gathers the h values of all tables and one that
+  sums them per order. On x86-64 CPUs with AVX2 support, we use gather
+  instructions for the first loop.
+
+  Callers must ensure that the abstract states they pass in have finite goal
+  distances in all abstractions. MaxCostPartitioningHeuristic guarantees this
+  by asking the UnsolvabilityHeuristic first.
+*/
+class FlatLookupTables {
+    std::vector<int> h_values;
+    std::vector<int> table_abstraction_ids;
+    std::vector<int> table_offsets;
+    std::vector<int> order_ends;
+
+    // Avoid allocating memory for each evaluation.
+    mutable std::vector<int> gathered_h_values;
+
+    void gather_h_values(const std::vector<int> &abstract_state_ids) const;
+
+public:
+    explicit FlatLookupTables(const CPHeuristics &cp_heuristics);
+
+    int compute_max_h(
+        const std::vector<int> &abstract_state_ids,
+        std::vector<int> *num_best_order = nullptr) const;
+
+    int get_num_orders() const;
+    int estimate_size_in_kb() const;
+};
+}
+
+#endif
@@ -0,0 +1,196 @@
+#include "heuristic_cache.h"
+
+#include "abstraction.h"
+#include "cost_partitioning_heuristic.h"
+#include "unsolvability_heuristic.h"
+
+#include "../task_proxy.h"
+
+#include "../algorithms/partial_state_tree.h"
+#include "../utils/hash.h"
+#include "../utils/logging.h"
+#include "../utils/serialization.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+namespace cost_saturation {
+static const string MAGIC = "SCPCACHE";
+// Increase the version whenever the file format changes.
+static const int FORMAT_VERSION = 4;
+
+static void feed_facts(utils::HashState &hash_state, const ConditionsProxy &facts) {
+    utils::feed(hash_state, static_cast<int>(facts.size()));
+    for (FactProxy fact : facts) {
+        utils::feed(hash_state, fact.get_pair().var);
+        utils::feed(hash_state, fact.get_pair().value);
+    }
+}
+
+template<typename OperatorsOrAxiomsProxy>
+static void feed_operators(
+    utils::HashState &hash_state, const OperatorsOrAxiomsProxy &operators) {
+    utils::feed(hash_state, static_cast<int>(operators.size()));
+    for (OperatorProxy op : operators) {
+        feed_facts(hash_state, op.get_preconditions());
+        EffectsProxy effects = op.get_effects();
+        utils::feed(hash_state, static_cast<int>(effects.size()));
+        for (EffectProxy effect : effects) {
+            feed_facts(hash_state, effect.get_conditions());
+            utils::feed(hash_state, effect.get_fact().get_pair().var);
+            utils::feed(hash_state, effect.get_fact().get_pair().value);
+        }
+        utils::feed(hash_state, op.get_cost());
+    }
+}
+
+static uint64_t compute_task_hash(const TaskProxy &task_proxy) {
+    utils::HashState hash_state;
+    VariablesProxy variables = task_proxy.get_variables();
+    utils::feed(hash_state, static_cast<int>(variables.size()));
+    for (VariableProxy var : variables) {
+        utils::feed(hash_state, var.get_domain_size());
+        // Non-derived variables have no axiom layer.
+        utils::feed(hash_state, var.is_derived() ? var.get_axiom_layer() : -1);
+    }
+    feed_operators(hash_state, task_proxy.get_operators());
+    feed_operators(hash_state, task_proxy.get_axioms());
+    State initial_state = task_proxy.get_initial_state();
+    initial_state.unpack();
+    utils::feed(hash_state, initial_state.get_unpacked_values());
+    GoalsProxy goals = task_proxy.get_goals();
+    utils::feed(hash_state, static_cast<int>(goals.size()));
+    for (FactProxy goal : goals) {
+        utils::feed(hash_state, goal.get_pair().var);
+        utils::feed(hash_state, goal.get_pair().value);
+    }
+    return hash_state.get_hash64();
+}
+
+static string get_cache_file_path(
+    const string &cache_dir, uint64_t task_hash, const string &config) {
+    uint64_t config_hash = utils::get_hash64(vector<int>(config.begin(), config.end()));
+    ostringstream filename;
+    filename << hex << setfill('0') << setw(16) << task_hash << "-"
+             << setw(16) << config_hash << ".scp";
+    return (filesystem::path(cache_dir) / filename.str()).string();
+}
+
+HeuristicCache::HeuristicCache(
+    const string &cache_dir, const TaskProxy &task_proxy, const string &config)
+    : config(config),
+      task_hash(compute_task_hash(task_proxy)),
+      path(get_cache_file_path(cache_dir, task_hash, config)) {
+}
+
+bool HeuristicCache::load(
+    AbstractionFunctions &abstraction_functions,
+    CPHeuristics &cp_heuristics,
+    UnsolvabilityHeuristic &unsolvability_heuristic,
+    DeadEnds &dead_ends) const {
+    ifstream is(path, ios::binary);
+    if (!is) {
+        utils::g_log << "No cached heuristic found at " << path << endl;
+        return false;
+    }
+    utils::g_log << "Loading cached heuristic from " << path << endl;
+
+    if (utils::read_binary_string(is) != MAGIC ||
+        utils::read_binary<int>(is) != FORMAT_VERSION ||
+        utils::read_binary<uint64_t>(is) != task_hash ||
+        utils::read_binary_string(is) != config || !is) {
+        utils::g_log << "Cached heuristic belongs to a different task, "
+                     << "configuration or format version." << endl;
+        return false;
+    }
+
+    abstraction_functions.clear();
+    int num_abstractions = utils::read_binary<int>(is);
+    for (int i = 0; i < num_abstractions && is; ++i) {
+        if (utils::read_binary<bool>(is)) {
+            abstraction_functions.push_back(load_abstraction_function(is));
+        } else {
+            abstraction_functions.push_back(nullptr);
+        }
+    }
+
+    // Don't allocate all heuristics up front since the count may be corrupted.
+    int num_cp_heuristics = utils::read_binary<int>(is);
+    cp_heuristics.clear();
+    for (int i = 0; i < num_cp_heuristics && is; ++i) {
+        cp_heuristics.emplace_back();
+        cp_heuristics.back().load(is);
+    }
+    unsolvability_heuristic.load(is);
+    dead_ends.load(is);
+
+    // Check that we read exactly the whole file.
+    if (!is || is.peek() != char_traits<char>::eof()) {
+        utils::g_log << "Cached heuristic is corrupted." << endl;
+        return false;
+    }
+    // Check that all lookups stay within the loaded tables.
+    for (const CostPartitioningHeuristic &cp_heuristic : cp_heuristics) {
+        if (!cp_heuristic.fits(abstraction_functions)) {
+            utils::g_log << "Cached heuristic has inconsistent lookup tables." << endl;
+            return false;
+        }
+    }
+    if (!unsolvability_heuristic.fits(abstraction_functions)) {
+        utils::g_log << "Cached heuristic has inconsistent lookup tables." << endl;
+        return false;
+    }
+    return true;
+}
+
+void HeuristicCache::save(
+    const AbstractionFunctions &abstraction_functions,
+    const CPHeuristics &cp_heuristics,
+    const UnsolvabilityHeuristic &unsolvability_heuristic,
+    const DeadEnds &dead_ends) const {
+    filesystem::path file_path(path);
+    error_code error;
+    filesystem::create_directories(file_path.parent_path(), error);
+    // Write to a temporary file first to avoid leaving half-written files.
+    filesystem::path tmp_path = file_path;
+    tmp_path += ".tmp";
+    {
+        ofstream os(tmp_path, ios::binary | ios::trunc);
+        utils::write_binary_string(os, MAGIC);
+        utils::write_binary(os, FORMAT_VERSION);
+        utils::write_binary(os, task_hash);
+        utils::write_binary_string(os, config);
+
+        utils::write_binary<int>(os, abstraction_functions.size());
+        for (const auto &abstraction_function : abstraction_functions) {
+            utils::write_binary<bool>(os, abstraction_function != nullptr);
+            if (abstraction_function) {
+                abstraction_function->save(os);
+            }
+        }
+        utils::write_binary<int>(os, cp_heuristics.size());
+        for (const CostPartitioningHeuristic &cp_heuristic : cp_heuristics) {
+            cp_heuristic.save(os);
+        }
+        unsolvability_heuristic.save(os);
+        dead_ends.save(os);
+
+        if (!os) {
+            utils::g_log << "Failed to write cached heuristic to " << tmp_path << endl;
+            filesystem::remove(tmp_path, error);
+            return;
+        }
+    }
+    filesystem::rename(tmp_path, file_path, error);
+    if (error) {
+        utils::g_log << "Failed to write cached heuristic to " << path << ": "
+                     << error.message() << endl;
+    } else {
+        utils::g_log << "Saved heuristic to cache file " << path << endl;
+    }
+}
+}
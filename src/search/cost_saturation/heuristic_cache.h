@@ -0,0 +1,55 @@
+#ifndef COST_SATURATION_HEURISTIC_CACHE_H
+#define COST_SATURATION_HEURISTIC_CACHE_H
+
+#include "types.h"
+
+#include <cstdint>
+#include <string>
+
+class TaskProxy;
+
+namespace cost_saturation {
+class UnsolvabilityHeuristic;
+
+/*
+  Store everything MaxCostPartitioningHeuristic needs during the search (the
+  useful abstraction functions, the lookup tables, the unsolvability
+  information and the dead ends) in a binary file, so that subsequent runs on
+  the same task with the same heuristic configuration can skip computing
+  abstractions and cost partitionings.
+
+  Files live in the given cache directory and are named after a hash of the
+  root task and the configuration string, from which the caller removes the
+  options that only affect the search. The file header repeats the task
+  hash and the configuration string, so we never use a file for the wrong
+  task or configuration, even if the hashes collide. Note that a stored
+  heuristic can differ from a newly computed one if the computation hits a
+  time limit.
+*/
+class HeuristicCache {
+    const std::string config;
+    const std::uint64_t task_hash;
+    const std::string path;
+
+public:
+    HeuristicCache(
+        const std::string &cache_dir,
+        const TaskProxy &task_proxy,
+        const std::string &config);
+
+    // Return true iff the cache file exists and could be read completely.
+    bool load(
+        AbstractionFunctions &abstraction_functions,
+        CPHeuristics &cp_heuristics,
+        UnsolvabilityHeuristic &unsolvability_heuristic,
+        DeadEnds &dead_ends) const;
+
+    void save(
+        const AbstractionFunctions &abstraction_functions,
+        const CPHeuristics &cp_heuristics,
+        const UnsolvabilityHeuristic &unsolvability_heuristic,
+        const DeadEnds &dead_ends) const;
+};
+}
+
+#endif
@@ -2,10 +2,14 @@
 
 #include "abstraction.h"
 #include "cost_partitioning_heuristic.h"
+#include "flat_lookup_tables.h"
 #include "utils.h"
 
 #include "../algorithms/partial_state_tree.h"
+#include "../plugins/options.h"
+#include "../utils/collections.h"
 #include "../utils/logging.h"
+#include "../utils/memory.h"
 
 using namespace std;
 
@@ -49,18 +53,152 @@ MaxCostPartitioningHeuristic::MaxCostPartitioningHeuristic(
     : Heuristic(opts),
       cp_heuristics(move(cp_heuristics_)),
       dead_ends(move(dead_ends_)),
-      unsolvability_heuristic(abstractions, cp_heuristics) {
+      unsolvability_heuristic(abstractions, cp_heuristics),
+      incremental(opts.get<bool>("incremental")),
+      last_operator_id(OperatorID::no_operator) {
     log_info_about_stored_lookup_tables(abstractions, cp_heuristics);
 
     // We only need abstraction functions during search and no transition systems.
     abstraction_functions = extract_abstraction_functions_from_useful_abstractions(
         cp_heuristics, &unsolvability_heuristic, abstractions);
+
+    initialize_lookup_tables(opts);
+    if (incremental) {
+        initialize_incremental_updates();
+    }
+}
+
+MaxCostPartitioningHeuristic::MaxCostPartitioningHeuristic(
+    const plugins::Options &opts,
+    AbstractionFunctions &&abstraction_functions_,
+    vector<CostPartitioningHeuristic> &&cp_heuristics_,
+    UnsolvabilityHeuristic &&unsolvability_heuristic_,
+    unique_ptr<DeadEnds> &&dead_ends_)
+    : Heuristic(opts),
+      abstraction_functions(move(abstraction_functions_)),
+      cp_heuristics(move(cp_heuristics_)),
+      dead_ends(move(dead_ends_)),
+      unsolvability_heuristic(move(unsolvability_heuristic_)),
+      incremental(opts.get<bool>("incremental")),
+      last_operator_id(OperatorID::no_operator) {
+    initialize_lookup_tables(opts);
+    if (incremental) {
+        initialize_incremental_updates();
+    }
+}
+
+void MaxCostPartitioningHeuristic::initialize_lookup_tables(const plugins::Options &opts) {
+    if (opts.get<bool>("flat_lookup_tables")) {
+        flat_lookup_tables = utils::make_unique_ptr<FlatLookupTables>(cp_heuristics);
+        utils::g_log << "Flat lookup tables size: "
+                     << flat_lookup_tables->estimate_size_in_kb() << " KiB" << endl;
+        utils::release_vector_memory(cp_heuristics);
+    }
+}
+
+void MaxCostPartitioningHeuristic::initialize_incremental_updates() {
+    VariablesProxy variables = task_proxy.get_variables();
+    vector<vector<int>> abstractions_by_var(variables.size());
+    int num_abstractions = abstraction_functions.size();
+    for (int i = 0; i < num_abstractions; ++i) {
+        if (abstraction_functions[i]) {
+            for (int var : abstraction_functions[i]->get_variables()) {
+                abstractions_by_var[var].push_back(i);
+            }
+        }
+    }
+    // Axioms may change derived variables after any operator.
+    vector<int> derived_vars;
+    for (VariableProxy var : variables) {
+        if (var.is_derived()) {
+            derived_vars.push_back(var.get_id());
+        }
+    }
+
+    OperatorsProxy operators = task_proxy.get_operators();
+    projection_updates_by_operator.resize(operators.size());
+    recomputed_abstractions_by_operator.resize(operators.size());
+    int num_projection_updates = 0;
+    int num_recomputed_abstractions = 0;
+    for (OperatorProxy op : operators) {
+        vector<int> changed_vars = derived_vars;
+        for (EffectProxy effect : op.get_effects()) {
+            changed_vars.push_back(effect.get_fact().get_variable().get_id());
+        }
+        utils::sort_unique(changed_vars);
+        vector<HashMultiplierDelta> &projection_updates =
+            projection_updates_by_operator[op.get_id()];
+        vector<int> &recomputed_abstractions =
+            recomputed_abstractions_by_operator[op.get_id()];
+        for (int var : changed_vars) {
+            for (int abstraction_id : abstractions_by_var[var]) {
+                int hash_multiplier =
+                    abstraction_functions[abstraction_id]->get_hash_multiplier(var);
+                if (hash_multiplier == -1) {
+                    recomputed_abstractions.push_back(abstraction_id);
+                } else {
+                    projection_updates.push_back(
+                        {abstraction_id, var, hash_multiplier});
+                }
+            }
+        }
+        utils::sort_unique(recomputed_abstractions);
+        projection_updates.shrink_to_fit();
+        recomputed_abstractions.shrink_to_fit();
+        num_projection_updates += projection_updates.size();
+        num_recomputed_abstractions += recomputed_abstractions.size();
+    }
+    int num_operators = operators.size();
+    utils::g_log << "Average projection updates per operator: "
+                 << num_projection_updates / static_cast<double>(num_operators)
+                 << endl;
+    utils::g_log << "Average recomputed abstractions per operator: "
+                 << num_recomputed_abstractions / static_cast<double>(num_operators)
+                 << endl;
 }
 
 MaxCostPartitioningHeuristic::~MaxCostPartitioningHeuristic() {
     print_statistics();
 }
 
+static bool is_same_registered_state(const State &state1, const State &state2) {
+    return state1.get_registry() && state1.get_registry() == state2.get_registry() &&
+           state1.get_id() == state2.get_id();
+}
+
+void MaxCostPartitioningHeuristic::notify_state_transition(
+    const State &parent_state, OperatorID op_id, const State &state) {
+    last_parent_state = parent_state;
+    last_operator_id = op_id;
+    last_state = state;
+}
+
+vector<int> MaxCostPartitioningHeuristic::compute_abstract_state_ids_incrementally(
+    const State &parent_state, OperatorID op_id, const State &state) {
+    if (!cached_parent_state ||
+        !is_same_registered_state(*cached_parent_state, parent_state)) {
+        cached_parent_state = parent_state;
+        cached_parent_state->unpack();
+        cached_parent_abstract_state_ids = get_abstract_state_ids(
+            abstraction_functions, *cached_parent_state);
+    }
+    const vector<int> &parent_values = cached_parent_state->get_unpacked_values();
+    state.unpack();
+    const vector<int> &values = state.get_unpacked_values();
+    vector<int> abstract_state_ids = cached_parent_abstract_state_ids;
+    for (const HashMultiplierDelta &delta :
+         projection_updates_by_operator[op_id.get_index()]) {
+        abstract_state_ids[delta.abstraction_id] +=
+            delta.hash_multiplier * (values[delta.var] - parent_values[delta.var]);
+    }
+    for (int abstraction_id : recomputed_abstractions_by_operator[op_id.get_index()]) {
+        abstract_state_ids[abstraction_id] =
+            abstraction_functions[abstraction_id]->get_abstract_state_id(state);
+    }
+    assert(abstract_state_ids == get_abstract_state_ids(abstraction_functions, state));
+    return abstract_state_ids;
+}
+
 int MaxCostPartitioningHeuristic::compute_heuristic(const State &ancestor_state) {
     assert(!task_proxy.needs_to_convert_ancestor_state(ancestor_state));
     // The conversion is unneeded but it results in an unpacked state, which is faster.
@@ -68,11 +206,20 @@ int MaxCostPartitioningHeuristic::compute_heuristic(const State &ancestor_state)
     if (dead_ends && dead_ends->subsumes(state)) {
         return DEAD_END;
     }
-    vector<int> abstract_state_ids = get_abstract_state_ids(
-        abstraction_functions, state);
+    vector<int> abstract_state_ids;
+    if (incremental && last_state &&
+        is_same_registered_state(*last_state, ancestor_state)) {
+        abstract_state_ids = compute_abstract_state_ids_incrementally(
+            *last_parent_state, last_operator_id, state);
+    } else {
+        abstract_state_ids = get_abstract_state_ids(abstraction_functions, state);
+    }
     if (unsolvability_heuristic.is_unsolvable(abstract_state_ids)) {
         return DEAD_END;
     }
+    if (flat_lookup_tables) {
+        return flat_lookup_tables->compute_max_h(abstract_state_ids, &num_best_order);
+    }
     return compute_max_h(cp_heuristics, abstract_state_ids, &num_best_order);
 }
 
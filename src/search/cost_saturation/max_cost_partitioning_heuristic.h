@@ -7,6 +7,7 @@
 #include "../heuristic.h"
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace options {
@@ -16,6 +17,7 @@ class Options;
 namespace cost_saturation {
 class AbstractionFunction;
 class CostPartitioningHeuristic;
+class FlatLookupTables;
 
 /*
   Compute the maximum over multiple cost partitioning heuristics.
@@ -23,12 +25,42 @@ class CostPartitioningHeuristic;
 class MaxCostPartitioningHeuristic : public Heuristic {
     std::vector<std::unique_ptr<AbstractionFunction>> abstraction_functions;
     std::vector<CostPartitioningHeuristic> cp_heuristics;
+    // If set, we store all lookup tables here instead of in cp_heuristics.
+    std::unique_ptr<FlatLookupTables> flat_lookup_tables;
     std::unique_ptr<DeadEnds> dead_ends;
     UnsolvabilityHeuristic unsolvability_heuristic;
 
+    /*
+      In incremental mode, the heuristic is path-dependent and computes the
+      abstract state IDs of a successor from the IDs of its parent. Only the
+      abstractions that depend on a variable changed by the operator (or on a
+      derived variable) need an update. For projections, we add the hash
+      multiplier times the value difference to the parent ID. For all other
+      abstractions, we look up the new ID.
+    */
+    struct HashMultiplierDelta {
+        int abstraction_id;
+        int var;
+        int hash_multiplier;
+    };
+    const bool incremental;
+    std::vector<std::vector<HashMultiplierDelta>> projection_updates_by_operator;
+    std::vector<std::vector<int>> recomputed_abstractions_by_operator;
+    // The last transition we have been notified about.
+    std::optional<State> last_parent_state;
+    OperatorID last_operator_id;
+    std::optional<State> last_state;
+    // Successors share their parent, so we cache its abstract state IDs.
+    std::optional<State> cached_parent_state;
+    std::vector<int> cached_parent_abstract_state_ids;
+
     // For statistics.
     mutable std::vector<int> num_best_order;
 
+    void initialize_lookup_tables(const plugins::Options &opts);
+    void initialize_incremental_updates();
+    std::vector<int> compute_abstract_state_ids_incrementally(
+        const State &parent_state, OperatorID op_id, const State &state);
     void print_statistics() const;
 
 protected:
@@ -40,7 +72,25 @@ public:
         Abstractions &&abstractions,
         std::vector<CostPartitioningHeuristic> &&cp_heuristics,
         std::unique_ptr<DeadEnds> &&dead_ends);
+    // Use precomputed abstraction functions and unsolvability information.
+    MaxCostPartitioningHeuristic(
+        const plugins::Options &opts,
+        AbstractionFunctions &&abstraction_functions,
+        std::vector<CostPartitioningHeuristic> &&cp_heuristics,
+        UnsolvabilityHeuristic &&unsolvability_heuristic,
+        std::unique_ptr<DeadEnds> &&dead_ends);
     virtual ~MaxCostPartitioningHeuristic() override;
+
+    virtual void get_path_dependent_evaluators(
+        std::set<Evaluator *> &evals) override {
+        if (incremental) {
+            evals.insert(this);
+        }
+    }
+
+    virtual void notify_state_transition(
+        const State &parent_state, OperatorID op_id,
+        const State &state) override;
 };
 }
 
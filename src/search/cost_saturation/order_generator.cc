@@ -10,6 +10,18 @@ OrderGenerator::OrderGenerator(const plugins::Options &opts)
     : rng(utils::parse_rng_from_options(opts)) {
 }
 
+Order OrderGenerator::compute_order_for_state(
+    const vector<int> &abstract_state_ids, bool verbose) {
+    return compute_order(abstract_state_ids, *rng, verbose);
+}
+
+Order OrderGenerator::compute_order_for_state(
+    const vector<int> &abstract_state_ids,
+    utils::RandomNumberGenerator &rng,
+    bool verbose) const {
+    return compute_order(abstract_state_ids, rng, verbose);
+}
+
 void add_common_order_generator_options(plugins::Feature &feature) {
     utils::add_rng_options(feature);
 }
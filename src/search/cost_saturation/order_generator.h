@@ -18,6 +18,13 @@ namespace cost_saturation {
 class OrderGenerator {
 protected:
     const std::shared_ptr<utils::RandomNumberGenerator> rng;
+
+    // Implementations must only draw random numbers from the given RNG.
+    virtual Order compute_order(
+        const std::vector<int> &abstract_state_ids,
+        utils::RandomNumberGenerator &rng,
+        bool verbose) const = 0;
+
 public:
     explicit OrderGenerator(const plugins::Options &opts);
     virtual ~OrderGenerator() = default;
@@ -25,8 +32,19 @@ public:
     virtual void initialize(
         const Abstractions &abstractions, const std::vector<int> &costs) = 0;
 
+    // Use the generator's own RNG. Only the main thread may call this method.
     virtual Order compute_order_for_state(
-        const std::vector<int> &abstract_state_ids, bool verbose) = 0;
+        const std::vector<int> &abstract_state_ids, bool verbose);
+
+    /*
+      Use the given RNG instead of the generator's own RNG. After
+      initialization, multiple threads may call this method concurrently as
+      long as they use different RNGs.
+    */
+    Order compute_order_for_state(
+        const std::vector<int> &abstract_state_ids,
+        utils::RandomNumberGenerator &rng,
+        bool verbose) const;
 };
 
 extern void add_common_order_generator_options(plugins::Feature &feature);
@@ -22,7 +22,8 @@ OrderGeneratorDynamicGreedy::OrderGeneratorDynamicGreedy(const plugins::Options
 
 Order OrderGeneratorDynamicGreedy::compute_dynamic_greedy_order_for_sample(
     const vector<int> &abstract_state_ids,
-    vector<int> remaining_costs) const {
+    vector<int> remaining_costs,
+    utils::RandomNumberGenerator &rng) const {
     assert(abstractions->size() == abstract_state_ids.size());
     vector<int> remaining_abstractions = get_default_order(abstractions->size());
 
@@ -35,7 +36,7 @@ Order OrderGeneratorDynamicGreedy::compute_dynamic_greedy_order_for_sample(
         current_saturated_costs.reserve(num_remaining);
 
         // Shuffle remaining abstractions to break ties randomly.
-        rng->shuffle(remaining_abstractions);
+        rng.shuffle(remaining_abstractions);
         vector<int> saturated_costs_for_best_abstraction;
         for (int abs_id : remaining_abstractions) {
             assert(utils::in_bounds(abs_id, abstract_state_ids));
@@ -82,13 +83,14 @@ void OrderGeneratorDynamicGreedy::initialize(
     costs = &costs_;
 }
 
-Order OrderGeneratorDynamicGreedy::compute_order_for_state(
+Order OrderGeneratorDynamicGreedy::compute_order(
     const vector<int> &abstract_state_ids,
-    bool verbose) {
+    utils::RandomNumberGenerator &rng,
+    bool verbose) const {
     assert(abstractions && costs);
     utils::Timer greedy_timer;
     vector<int> order = compute_dynamic_greedy_order_for_sample(
-        abstract_state_ids, *costs);
+        abstract_state_ids, *costs, rng);
 
     if (verbose) {
         utils::g_log << "Time for computing dynamic greedy order: "
@@ -17,7 +17,14 @@ class OrderGeneratorDynamicGreedy : public OrderGenerator {
 
     Order compute_dynamic_greedy_order_for_sample(
         const std::vector<int> &abstract_state_ids,
-        std::vector<int> remaining_costs) const;
+        std::vector<int> remaining_costs,
+        utils::RandomNumberGenerator &rng) const;
+
+protected:
+    virtual Order compute_order(
+        const std::vector<int> &abstract_state_ids,
+        utils::RandomNumberGenerator &rng,
+        bool verbose) const override;
 
 public:
     explicit OrderGeneratorDynamicGreedy(const plugins::Options &opts);
@@ -25,10 +32,6 @@ public:
     virtual void initialize(
         const Abstractions &abstractions,
         const std::vector<int> &costs) override;
-
-    virtual Order compute_order_for_state(
-        const std::vector<int> &abstract_state_ids,
-        bool verbose) override;
 };
 }
 
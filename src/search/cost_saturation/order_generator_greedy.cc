@@ -64,15 +64,16 @@ void OrderGeneratorGreedy::initialize(
                  << timer << endl;
 }
 
-Order OrderGeneratorGreedy::compute_order_for_state(
+Order OrderGeneratorGreedy::compute_order(
     const vector<int> &abstract_state_ids,
-    bool verbose) {
+    utils::RandomNumberGenerator &rng,
+    bool verbose) const {
     assert(abstract_state_ids.size() == h_values_by_abstraction.size());
     utils::Timer greedy_timer;
     int num_abstractions = abstract_state_ids.size();
     Order order = get_default_order(num_abstractions);
     // Shuffle order to break ties randomly.
-    rng->shuffle(order);
+    rng.shuffle(order);
     vector<double> scores;
     scores.reserve(num_abstractions);
     for (int abs = 0; abs < num_abstractions; ++abs) {
@@ -20,16 +20,18 @@ class OrderGeneratorGreedy : public OrderGenerator {
         const std::vector<int> &abstract_state_ids,
         int abs_id) const;
 
+protected:
+    virtual Order compute_order(
+        const std::vector<int> &abstract_state_ids,
+        utils::RandomNumberGenerator &rng,
+        bool verbose) const override;
+
 public:
     explicit OrderGeneratorGreedy(const plugins::Options &opts);
 
     virtual void initialize(
         const Abstractions &abstractions,
         const std::vector<int> &costs) override;
-
-    virtual Order compute_order_for_state(
-        const std::vector<int> &abstract_state_ids,
-        bool verbose) override;
 };
 }
 
@@ -23,10 +23,20 @@ void OrderGeneratorRandom::initialize(
 Order OrderGeneratorRandom::compute_order_for_state(
     const vector<int> &,
     bool) {
+    // The sequential computation reshuffles the previous order.
     rng->shuffle(random_order);
     return random_order;
 }
 
+Order OrderGeneratorRandom::compute_order(
+    const vector<int> &,
+    utils::RandomNumberGenerator &rng,
+    bool) const {
+    Order order = random_order;
+    rng.shuffle(order);
+    return order;
+}
+
 class OrderGeneratorRandomFeature
     : public plugins::TypedFeature<OrderGenerator, OrderGeneratorRandom> {
 public:
@@ -6,6 +6,13 @@
 namespace cost_saturation {
 class OrderGeneratorRandom : public OrderGenerator {
     std::vector<int> random_order;
+
+protected:
+    virtual Order compute_order(
+        const std::vector<int> &abstract_state_ids,
+        utils::RandomNumberGenerator &rng,
+        bool verbose) const override;
+
 public:
     explicit OrderGeneratorRandom(const plugins::Options &opts);
 
@@ -13,9 +20,9 @@ public:
         const Abstractions &abstractions,
         const std::vector<int> &costs) override;
 
+    using OrderGenerator::compute_order_for_state;
     virtual Order compute_order_for_state(
-        const std::vector<int> &abstract_state_ids,
-        bool verbose) override;
+        const std::vector<int> &abstract_state_ids, bool verbose) override;
 };
 }
 
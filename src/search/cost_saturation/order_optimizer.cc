@@ -6,6 +6,7 @@
 #include "../utils/logging.h"
 
 #include <cassert>
+#include <cstdint>
 
 using namespace std;
 
@@ -16,6 +17,56 @@ static void log_better_order(const vector<int> &order, int h, int i, int j) {
     utils::g_log << "Found improving order with h=" << h << ": " << order << endl;
 }
 
+static int add_h_values(int h1, int h2) {
+    return (h1 == INF || h2 == INF) ? INF : h1 + h2;
+}
+
+/*
+  Remaining costs and heuristic values before each position of the
+  incumbent order.
+*/
+class PrefixCache {
+    const CPFunction &cp_function;
+    const Abstractions &abstractions;
+    const vector<int> &abstract_state_ids;
+    vector<vector<int>> remaining_costs_before;
+    vector<int> h_before;
+
+public:
+    PrefixCache(
+        const CPFunction &cp_function,
+        const Abstractions &abstractions,
+        const vector<int> &costs,
+        const vector<int> &abstract_state_ids)
+        : cp_function(cp_function),
+          abstractions(abstractions),
+          abstract_state_ids(abstract_state_ids),
+          remaining_costs_before(abstractions.size(), costs),
+          h_before(abstractions.size(), 0) {
+    }
+
+    // Recompute the prefix data for all positions after the given one.
+    void update(const Order &order, int first_changed_pos) {
+        int num_abstractions = order.size();
+        for (int pos = first_changed_pos; pos < num_abstractions - 1; ++pos) {
+            remaining_costs_before[pos + 1] = remaining_costs_before[pos];
+            CostPartitioningHeuristic cp = cp_function.compute(
+                abstractions, {order[pos]}, remaining_costs_before[pos + 1],
+                abstract_state_ids);
+            h_before[pos + 1] = add_h_values(
+                h_before[pos], cp.compute_heuristic(abstract_state_ids));
+        }
+    }
+
+    const vector<int> &get_remaining_costs_before(int pos) const {
+        return remaining_costs_before[pos];
+    }
+
+    int get_h_before(int pos) const {
+        return h_before[pos];
+    }
+};
+
 static bool search_improving_successor(
     CPFunction const &cp_function,
     const utils::CountdownTimer &timer,
@@ -33,7 +84,7 @@ static bool search_improving_successor(
 
             vector<int> remaining_costs = costs;
             CostPartitioningHeuristic neighbor_cp =
-                cp_function(abstractions, incumbent_order, remaining_costs, abstract_state_ids);
+                cp_function.compute(abstractions, incumbent_order, remaining_costs, abstract_state_ids);
 
             int h = neighbor_cp.compute_heuristic(abstract_state_ids);
             if (h > incumbent_h_value) {
@@ -52,6 +103,58 @@ static bool search_improving_successor(
     return false;
 }
 
+static bool search_improving_successor_incrementally(
+    CPFunction const &cp_function,
+    const utils::CountdownTimer &timer,
+    const Abstractions &abstractions,
+    const vector<int> &costs,
+    const vector<int> &abstract_state_ids,
+    PrefixCache &prefix_cache,
+    vector<int> &incumbent_order,
+    CostPartitioningHeuristic &incumbent_cp,
+    int &incumbent_h_value,
+    int64_t &num_reused_abstractions,
+    int64_t &num_recomputed_abstractions,
+    bool verbose) {
+    int num_abstractions = abstractions.size();
+    for (int i = 0; i < num_abstractions && !timer.is_expired(); ++i) {
+        int h_before = prefix_cache.get_h_before(i);
+        if (h_before == INF) {
+            // No neighbor swapping positions i and later can be better.
+            break;
+        }
+        Order suffix(incumbent_order.begin() + i, incumbent_order.end());
+        for (int j = i + 1; j < num_abstractions && !timer.is_expired(); ++j) {
+            swap(suffix[0], suffix[j - i]);
+
+            vector<int> remaining_costs = prefix_cache.get_remaining_costs_before(i);
+            CostPartitioningHeuristic suffix_cp =
+                cp_function.compute(abstractions, suffix, remaining_costs, abstract_state_ids);
+            num_reused_abstractions += i;
+            num_recomputed_abstractions += num_abstractions - i;
+
+            int h = add_h_values(h_before, suffix_cp.compute_heuristic(abstract_state_ids));
+            if (h > incumbent_h_value) {
+                swap(incumbent_order[i], incumbent_order[j]);
+                remaining_costs = costs;
+                incumbent_cp = cp_function.compute(
+                    abstractions, incumbent_order, remaining_costs, abstract_state_ids);
+                assert(incumbent_cp.compute_heuristic(abstract_state_ids) == h);
+                incumbent_h_value = h;
+                prefix_cache.update(incumbent_order, i);
+                if (verbose) {
+                    log_better_order(incumbent_order, h, i, j);
+                }
+                return true;
+            } else {
+                // Restore incumbent suffix.
+                swap(suffix[0], suffix[j - i]);
+            }
+        }
+    }
+    return false;
+}
+
 
 void optimize_order_with_hill_climbing(
     const CPFunction &cp_function,
@@ -66,13 +169,35 @@ void optimize_order_with_hill_climbing(
     if (verbose) {
         utils::g_log << "Incumbent h value: " << incumbent_h_value << endl;
     }
+    if (!cp_function.is_sequential) {
+        while (!timer.is_expired()) {
+            bool success = search_improving_successor(
+                cp_function, timer, abstractions, costs, abstract_state_ids,
+                incumbent_order, incumbent_cp, incumbent_h_value, verbose);
+            if (!success) {
+                break;
+            }
+        }
+        return;
+    }
+
+    PrefixCache prefix_cache(cp_function, abstractions, costs, abstract_state_ids);
+    prefix_cache.update(incumbent_order, 0);
+    int64_t num_reused_abstractions = 0;
+    int64_t num_recomputed_abstractions = 0;
     while (!timer.is_expired()) {
-        bool success = search_improving_successor(
+        bool success = search_improving_successor_incrementally(
             cp_function, timer, abstractions, costs, abstract_state_ids,
-            incumbent_order, incumbent_cp, incumbent_h_value, verbose);
+            prefix_cache, incumbent_order, incumbent_cp, incumbent_h_value,
+            num_reused_abstractions, num_recomputed_abstractions, verbose);
         if (!success) {
             break;
         }
     }
+    if (verbose) {
+        utils::g_log << "Abstractions reused/recomputed for evaluating neighbors: "
+                     << num_reused_abstractions << "/"
+                     << num_recomputed_abstractions << endl;
+    }
 }
 }
@@ -10,6 +10,11 @@ class CountdownTimer;
 namespace cost_saturation {
 /*
   Optimize the given order in-place via simple hill climbing.
+
+  For sequential cost partitioning functions, we cache the remaining costs and the
+  heuristic value for each prefix of the incumbent order. A neighbor that
+  swaps positions i < j then only needs to recompute the suffix starting at
+  position i.
 */
 extern void optimize_order_with_hill_climbing(
     const CPFunction &cp_function,
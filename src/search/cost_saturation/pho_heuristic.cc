@@ -144,11 +144,16 @@ public:
         add_options_for_cost_partitioning_heuristic(*this);
         add_option<bool>("saturated", "saturate costs", "true");
         add_order_options(*this);
+        add_lookup_table_options(*this);
         lp::add_lp_solver_option_to_feature(*this);
     }
 
     virtual shared_ptr<ScaledCostPartitioningHeuristic> create_component(
-        const plugins::Options &options, const utils::Context &) const override {
+        const plugins::Options &options, const utils::Context &context) const override {
+        if (options.get<int>("threads") > 1) {
+            context.error("pho() does not support threads > 1 since LP solvers "
+                          "must not be shared between threads.");
+        }
         shared_ptr<AbstractTask> scaled_costs_task =
             get_scaled_costs_task(options.get<shared_ptr<AbstractTask>>("transform"));
         plugins::Options options_with_scaled_costs_task = options;
@@ -161,12 +166,14 @@ public:
         PhO pho(abstractions, costs, options.get<lp::LPSolverType>("lpsolver"),
                 options.get<bool>("saturated"),
                 utils::get_log_from_options(options));
-        CPFunction cp_function = [&pho](const Abstractions &abstractions_,
-                                        const vector<int> &order_,
-                                        const vector<int> &costs_,
-                                        const vector<int> &abstract_state_ids) {
+        CPFunction cp_function{
+            [&pho](const Abstractions &abstractions_,
+                   const vector<int> &order_,
+                   const vector<int> &costs_,
+                   const vector<int> &abstract_state_ids) {
                 return pho.compute_cost_partitioning(abstractions_, order_, costs_, abstract_state_ids);
-            };
+            },
+            false};
         vector<CostPartitioningHeuristic> cp_heuristics =
             get_cp_heuristic_collection_generator_from_options(options).generate_cost_partitionings(
                 task_proxy, abstractions, costs, cp_function);
@@ -6,18 +6,152 @@
 
 #include "../algorithms/priority_queues.h"
 #include "../pdbs/slim_match_tree.h"
+#include "../tasks/root_task.h"
 #include "../task_utils/task_properties.h"
 #include "../utils/collections.h"
 #include "../utils/logging.h"
 #include "../utils/math.h"
 #include "../utils/memory.h"
+#include "../utils/serialization.h"
 
 #include <cassert>
+#include <deque>
+#include <limits>
+#include <type_traits>
 #include <unordered_map>
 
 using namespace std;
 
 namespace cost_saturation {
+/*
+  Store backward transitions in flat arrays only if there are at most this
+  many (8 bytes each). Larger projections use the match tree, which needs
+  much less memory.
+*/
+static const int MAX_BACKWARD_EDGES = 1 << 16;
+
+enum class LabelCostType {
+    // All finite label costs are equal.
+    UNIFORM,
+    // All finite label costs are 0 or c for a single c > 0.
+    ZERO_OR_CONSTANT,
+    GENERAL
+};
+
+static LabelCostType classify_label_costs(
+    const vector<int> &label_costs, int &positive_cost) {
+    bool has_zero_cost = false;
+    positive_cost = -1;
+    for (int cost : label_costs) {
+        if (cost == INF) {
+            continue;
+        } else if (cost == 0) {
+            has_zero_cost = true;
+        } else if (positive_cost == -1) {
+            positive_cost = cost;
+        } else if (cost != positive_cost) {
+            return LabelCostType::GENERAL;
+        }
+    }
+    if (has_zero_cost && positive_cost != -1) {
+        return LabelCostType::ZERO_OR_CONSTANT;
+    }
+    if (positive_cost == -1) {
+        positive_cost = 0;
+    }
+    return LabelCostType::UNIFORM;
+}
+
+/*
+  Breadth-first search for uniform costs. Each state is expanded once and
+  its distance is the distance of its parent plus the uniform cost.
+*/
+template<typename ForEachBackwardEdge>
+static void compute_distances_with_bfs(
+    const vector<int> &label_costs,
+    int cost,
+    const ForEachBackwardEdge &for_each_backward_edge,
+    vector<int> &distances,
+    vector<int> &queue) {
+    for (size_t i = 0; i < queue.size(); ++i) {
+        int state = queue[i];
+        int predecessor_distance = distances[state] + cost;
+        for_each_backward_edge(state, [&](int predecessor, int label) {
+                                   if (label_costs[label] != INF &&
+                                       distances[predecessor] == INF) {
+                                       distances[predecessor] = predecessor_distance;
+                                       queue.push_back(predecessor);
+                                   }
+                               });
+    }
+}
+
+/*
+  0-1 BFS for costs 0 and c: states reached via 0-cost labels are added to
+  the front of the deque, others to the back. Since popped distances never
+  decrease, we close states when we pop them the first time.
+*/
+template<typename ForEachBackwardEdge>
+static void compute_distances_with_zero_one_bfs(
+    const vector<int> &label_costs,
+    const ForEachBackwardEdge &for_each_backward_edge,
+    vector<int> &distances,
+    deque<int> &queue) {
+    vector<bool> closed(distances.size(), false);
+    while (!queue.empty()) {
+        int state = queue.front();
+        queue.pop_front();
+        if (closed[state]) {
+            continue;
+        }
+        closed[state] = true;
+        int distance = distances[state];
+        for_each_backward_edge(state, [&](int predecessor, int label) {
+                                   int cost = label_costs[label];
+                                   if (cost == INF) {
+                                       return;
+                                   }
+                                   int alternative_cost = distance + cost;
+                                   if (alternative_cost < distances[predecessor]) {
+                                       distances[predecessor] = alternative_cost;
+                                       if (cost == 0) {
+                                           queue.push_front(predecessor);
+                                       } else {
+                                           queue.push_back(predecessor);
+                                       }
+                                   }
+                               });
+    }
+}
+
+template<typename ForEachBackwardEdge>
+static void compute_distances_with_dijkstra(
+    const vector<int> &label_costs,
+    const ForEachBackwardEdge &for_each_backward_edge,
+    vector<int> &distances,
+    priority_queues::AdaptiveQueue<int> &pq) {
+    while (!pq.empty()) {
+        pair<int, size_t> node = pq.pop();
+        int distance = node.first;
+        int state_index = node.second;
+        assert(utils::in_bounds(state_index, distances));
+        if (distance > distances[state_index]) {
+            continue;
+        }
+
+        for_each_backward_edge(state_index, [&](int predecessor, int label) {
+                                   assert(utils::in_bounds(label, label_costs));
+                                   int alternative_cost = (label_costs[label] == INF) ?
+                                       INF : distances[state_index] + label_costs[label];
+                                   assert(utils::in_bounds(predecessor, distances));
+                                   if (alternative_cost < distances[predecessor]) {
+                                       distances[predecessor] = alternative_cost;
+                                       pq.push(alternative_cost, predecessor);
+                                   }
+                               });
+    }
+}
+
 static vector<int> get_abstract_preconditions(
     const vector<FactPair> &prev_pairs,
     const vector<FactPair> &pre_pairs,
@@ -223,7 +357,9 @@ bool TaskInfo::operator_is_active(const pdbs::Pattern &pattern, int op_id) const
 
 
 ProjectionFunction::ProjectionFunction(
-    const pdbs::Pattern &pattern, const vector<int> &hash_multipliers) {
+    const pdbs::Pattern &pattern, const vector<int> &hash_multipliers,
+    int num_states)
+    : num_states(num_states) {
     assert(pattern.size() == hash_multipliers.size());
     variables_and_multipliers.reserve(pattern.size());
     for (size_t i = 0; i < pattern.size(); ++i) {
@@ -231,6 +367,35 @@ ProjectionFunction::ProjectionFunction(
     }
 }
 
+ProjectionFunction::ProjectionFunction(istream &is) {
+    static_assert(is_trivially_copyable_v<VariableAndMultiplier>);
+    variables_and_multipliers = utils::read_binary_vector<VariableAndMultiplier>(
+        is, VariableAndMultiplier(-1, 0));
+    num_states = utils::read_binary<int>(is);
+    if (is && !is_valid()) {
+        is.setstate(ios::failbit);
+    }
+}
+
+bool ProjectionFunction::is_valid() const {
+    VariablesProxy variables = TaskProxy(*tasks::g_root_task).get_variables();
+    int num_vars = variables.size();
+    int prev_var = -1;
+    int64_t expected_multiplier = 1;
+    for (const VariableAndMultiplier &pair : variables_and_multipliers) {
+        if (pair.pattern_var <= prev_var || pair.pattern_var >= num_vars ||
+            pair.hash_multiplier != expected_multiplier) {
+            return false;
+        }
+        prev_var = pair.pattern_var;
+        expected_multiplier *= variables[pair.pattern_var].get_domain_size();
+        if (expected_multiplier > numeric_limits<int>::max()) {
+            return false;
+        }
+    }
+    return num_states == expected_multiplier;
+}
+
 int ProjectionFunction::get_abstract_state_id(const State &concrete_state) const {
     int index = 0;
     for (const VariableAndMultiplier &pair : variables_and_multipliers) {
@@ -239,6 +404,49 @@ int ProjectionFunction::get_abstract_state_id(const State &concrete_state) const
     return index;
 }
 
+void ProjectionFunction::get_abstract_state_ids(
+    const vector<State> &states, vector<int> &state_ids) const {
+    int num_states = states.size();
+    state_ids.resize(num_states);
+    for (int i = 0; i < num_states; ++i) {
+        states[i].unpack();
+        const int *values = states[i].get_unpacked_values().data();
+        int index = 0;
+        for (const VariableAndMultiplier &pair : variables_and_multipliers) {
+            index += pair.hash_multiplier * values[pair.pattern_var];
+        }
+        state_ids[i] = index;
+    }
+}
+
+vector<int> ProjectionFunction::get_variables() const {
+    vector<int> variables;
+    variables.reserve(variables_and_multipliers.size());
+    for (const VariableAndMultiplier &pair : variables_and_multipliers) {
+        variables.push_back(pair.pattern_var);
+    }
+    return variables;
+}
+
+int ProjectionFunction::get_hash_multiplier(int var) const {
+    for (const VariableAndMultiplier &pair : variables_and_multipliers) {
+        if (pair.pattern_var == var) {
+            return pair.hash_multiplier;
+        }
+    }
+    return 0;
+}
+
+int ProjectionFunction::get_num_states() const {
+    return num_states;
+}
+
+void ProjectionFunction::save(ostream &os) const {
+    utils::write_binary(os, AbstractionFunctionType::PROJECTION);
+    utils::write_binary_vector(os, variables_and_multipliers);
+    utils::write_binary(os, num_states);
+}
+
 
 Projection::Projection(
     const TaskProxy &task_proxy,
@@ -269,7 +477,7 @@ Projection::Projection(
     }
 
     abstraction_function = utils::make_unique_ptr<ProjectionFunction>(
-        pattern, hash_multipliers);
+        pattern, hash_multipliers, num_states);
 
     VariablesProxy variables = task_proxy.get_variables();
     vector<int> variable_to_pattern_index(variables.size(), -1);
@@ -335,6 +543,58 @@ Projection::Projection(
     ranked_operators.shrink_to_fit();
 
     goal_states = compute_goal_states(variable_to_pattern_index);
+
+    if (compute_backward_edges()) {
+        match_tree_backward = nullptr;
+    }
+}
+
+bool Projection::compute_backward_edges() {
+    /*
+      Each ranked operator induces one transition for each assignment to the
+      pattern variables that its representative operator doesn't mention.
+    */
+    int total_num_edges = 0;
+    for (const RankedOperator &ranked_operator : ranked_operators) {
+        int concrete_op_id = *label_to_operators.get_slice(ranked_operator.label).begin();
+        int num_transitions = 1;
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            if (!task_info->operator_mentions_variable(concrete_op_id, pattern[i])) {
+                if (!utils::is_product_within_limit(
+                        num_transitions, pattern_domain_sizes[i], MAX_BACKWARD_EDGES)) {
+                    return false;
+                }
+                num_transitions *= pattern_domain_sizes[i];
+            }
+        }
+        total_num_edges += num_transitions;
+        if (total_num_edges > MAX_BACKWARD_EDGES) {
+            return false;
+        }
+    }
+
+    // Count the backward edges of each state, then fill the arrays.
+    vector<int> num_edges(num_states, 0);
+    for_each_label_transition(
+        [&](const Transition &t) {
+            ++num_edges[t.target];
+        });
+
+    backward_edge_offsets.resize(num_states + 1);
+    backward_edge_offsets[0] = 0;
+    for (int state = 0; state < num_states; ++state) {
+        backward_edge_offsets[state + 1] = backward_edge_offsets[state] + num_edges[state];
+    }
+    // Reuse num_edges as the next free position for each state.
+    for (int state = 0; state < num_states; ++state) {
+        num_edges[state] = backward_edge_offsets[state];
+    }
+    backward_edges.assign(total_num_edges, BackwardEdge(-1, -1));
+    for_each_label_transition(
+        [&](const Transition &t) {
+            backward_edges[num_edges[t.target]++] = BackwardEdge(t.src, t.op);
+        });
+    return true;
 }
 
 Projection::~Projection() {
@@ -514,6 +774,42 @@ int Projection::get_num_operators() const {
     return task_info->get_num_operators();
 }
 
+template<typename ForEachBackwardEdge>
+vector<int> Projection::compute_goal_distances(
+    const vector<int> &label_costs,
+    const ForEachBackwardEdge &for_each_backward_edge) const {
+    vector<int> distances(num_states, INF);
+    int positive_cost;
+    LabelCostType cost_type = classify_label_costs(label_costs, positive_cost);
+    if (cost_type == LabelCostType::UNIFORM) {
+        vector<int> queue;
+        queue.reserve(num_states);
+        for (int goal : goal_states) {
+            queue.push_back(goal);
+            distances[goal] = 0;
+        }
+        compute_distances_with_bfs(
+            label_costs, positive_cost, for_each_backward_edge, distances, queue);
+    } else if (cost_type == LabelCostType::ZERO_OR_CONSTANT) {
+        deque<int> queue;
+        for (int goal : goal_states) {
+            queue.push_back(goal);
+            distances[goal] = 0;
+        }
+        compute_distances_with_zero_one_bfs(
+            label_costs, for_each_backward_edge, distances, queue);
+    } else {
+        priority_queues::AdaptiveQueue<int> pq;
+        for (int goal : goal_states) {
+            pq.push(0, goal);
+            distances[goal] = 0;
+        }
+        compute_distances_with_dijkstra(
+            label_costs, for_each_backward_edge, distances, pq);
+    }
+    return distances;
+}
+
 vector<int> Projection::compute_goal_distances(const vector<int> &operator_costs) const {
     assert(all_of(operator_costs.begin(), operator_costs.end(), [](int c) {return c >= 0;}));
 
@@ -529,46 +825,31 @@ vector<int> Projection::compute_goal_distances(const vector<int> &operator_costs
         label_costs.push_back(min_cost);
     }
 
-    vector<int> distances(num_states, INF);
-
-    // Initialize queue.
-    priority_queues::AdaptiveQueue<int> pq;
-    for (int goal : goal_states) {
-        pq.push(0, goal);
-        distances[goal] = 0;
+    if (!match_tree_backward) {
+        return compute_goal_distances(
+            label_costs,
+            [this](int state, const auto &callback) {
+                for (int i = backward_edge_offsets[state];
+                     i < backward_edge_offsets[state + 1]; ++i) {
+                    const BackwardEdge &edge = backward_edges[i];
+                    callback(edge.predecessor, edge.label);
+                }
+            });
     }
 
     // Reuse vector to save allocations.
     vector<int> applicable_operators;
-
-    // Run Dijkstra loop.
-    while (!pq.empty()) {
-        pair<int, size_t> node = pq.pop();
-        int distance = node.first;
-        int state_index = node.second;
-        assert(utils::in_bounds(state_index, distances));
-        if (distance > distances[state_index]) {
-            continue;
-        }
-
-        // Regress abstract state.
-        applicable_operators.clear();
-        match_tree_backward->get_applicable_operator_ids(
-            state_index, applicable_operators);
-        for (int ranked_op_id : applicable_operators) {
-            const RankedOperator &op = ranked_operators[ranked_op_id];
-            int predecessor = state_index - op.hash_effect;
-            assert(utils::in_bounds(op.label, label_costs));
-            int alternative_cost = (label_costs[op.label] == INF) ?
-                INF : distances[state_index] + label_costs[op.label];
-            assert(utils::in_bounds(predecessor, distances));
-            if (alternative_cost < distances[predecessor]) {
-                distances[predecessor] = alternative_cost;
-                pq.push(alternative_cost, predecessor);
+    return compute_goal_distances(
+        label_costs,
+        [this, &applicable_operators](int state, const auto &callback) {
+            applicable_operators.clear();
+            match_tree_backward->get_applicable_operator_ids(
+                state, applicable_operators);
+            for (int ranked_op_id : applicable_operators) {
+                const RankedOperator &op = ranked_operators[ranked_op_id];
+                callback(state - op.hash_effect, op.label);
             }
-        }
-    }
-    return distances;
+        });
 }
 
 int Projection::get_num_states() const {
@@ -76,12 +76,25 @@ class ProjectionFunction : public AbstractionFunction {
         }
     };
     std::vector<VariableAndMultiplier> variables_and_multipliers;
+    int num_states;
+
+    // Check that the IDs of root task states are in [0, num_states).
+    bool is_valid() const;
 
 public:
     ProjectionFunction(
-        const pdbs::Pattern &pattern, const std::vector<int> &hash_multipliers);
+        const pdbs::Pattern &pattern, const std::vector<int> &hash_multipliers,
+        int num_states);
+    // Read a function that has been written with save() (without the type tag).
+    explicit ProjectionFunction(std::istream &is);
 
     virtual int get_abstract_state_id(const State &concrete_state) const override;
+    virtual void get_abstract_state_ids(
+        const std::vector<State> &states, std::vector<int> &state_ids) const override;
+    virtual std::vector<int> get_variables() const override;
+    virtual int get_hash_multiplier(int var) const override;
+    virtual int get_num_states() const override;
+    virtual void save(std::ostream &os) const override;
 };
 
 
@@ -99,6 +112,23 @@ class Projection : public Abstraction {
     std::vector<RankedOperator> ranked_operators;
     std::unique_ptr<pdbs::SlimMatchTree> match_tree_backward;
 
+    /*
+      For small projections, we store the backward transitions of each
+      abstract state in a flat array (compressed sparse rows) and discard the
+      match tree. The backward edges of state s are
+      backward_edges[backward_edge_offsets[s]..backward_edge_offsets[s+1]).
+    */
+    struct BackwardEdge {
+        int predecessor;
+        int label;
+
+        BackwardEdge(int predecessor, int label)
+            : predecessor(predecessor), label(label) {
+        }
+    };
+    std::vector<int> backward_edge_offsets;
+    std::vector<BackwardEdge> backward_edges;
+
     // Number of abstract states in the projection.
     int num_states;
 
@@ -113,6 +143,14 @@ class Projection : public Abstraction {
     std::vector<int> compute_goal_states(
         const std::vector<int> &variable_to_pattern_index) const;
 
+    // Return true iff the backward edges fit into the size limit.
+    bool compute_backward_edges();
+
+    template<typename ForEachBackwardEdge>
+    std::vector<int> compute_goal_distances(
+        const std::vector<int> &label_costs,
+        const ForEachBackwardEdge &for_each_backward_edge) const;
+
     /*
       Given an abstract state (represented as a vector of facts), compute the
       "next" fact. Return true iff there is a next fact.
@@ -20,7 +20,8 @@ CostPartitioningHeuristic compute_saturated_cost_partitioning(
     const vector<int> &order,
     vector<int> &remaining_costs,
     const vector<int> &) {
-    assert(abstractions.size() == order.size());
+    // Sequential cost partitionings also support partial orders.
+    assert(order.size() <= abstractions.size());
     CostPartitioningHeuristic cp_heuristic;
     for (int pos : order) {
         const Abstraction &abstraction = *abstractions[pos];
@@ -46,7 +47,8 @@ CostPartitioningHeuristic compute_perim_saturated_cost_partitioning(
     const vector<int> &order,
     vector<int> &remaining_costs,
     const vector<int> &abstract_state_ids) {
-    assert(abstractions.size() == order.size());
+    // Sequential cost partitionings also support partial orders.
+    assert(order.size() <= abstractions.size());
     CostPartitioningHeuristic cp_heuristic;
     for (int pos : order) {
         const Abstraction &abstraction = *abstractions[pos];
@@ -81,13 +83,15 @@ void add_saturator_option(plugins::Feature &feature) {
 
 CPFunction get_cp_function_from_options(const plugins::Options &options) {
     Saturator saturator_type = options.get<Saturator>("saturator");
-    CPFunction cp_function = nullptr;
+    CPFunction cp_function{nullptr, true};
     if (saturator_type == Saturator::ALL) {
-        cp_function = compute_saturated_cost_partitioning;
+        cp_function.compute = compute_saturated_cost_partitioning;
     } else if (saturator_type == Saturator::PERIM) {
-        cp_function = compute_perim_saturated_cost_partitioning;
+        cp_function.compute = compute_perim_saturated_cost_partitioning;
     } else if (saturator_type == Saturator::PERIMSTAR) {
-        cp_function = compute_perimstar_saturated_cost_partitioning;
+        cp_function.compute = compute_perimstar_saturated_cost_partitioning;
+        // Perimstar runs a second pass over the order.
+        cp_function.is_sequential = false;
     } else {
         ABORT("Invalid value for saturator.");
     }
@@ -124,25 +128,14 @@ public:
         add_options_for_cost_partitioning_heuristic(*this);
         add_saturator_option(*this);
         add_order_options(*this);
+        add_lookup_table_options(*this);
+        add_cache_options(*this);
     }
 
     virtual shared_ptr<MaxCostPartitioningHeuristic> create_component(
         const plugins::Options &options, const utils::Context &) const override {
-        shared_ptr<AbstractTask> task = options.get<shared_ptr<AbstractTask>>("transform");
-        TaskProxy task_proxy(*task);
-        vector<int> costs = task_properties::get_operator_costs(task_proxy);
-        unique_ptr<DeadEnds> dead_ends = utils::make_unique_ptr<DeadEnds>();
-        Abstractions abstractions = generate_abstractions(
-            task, options.get_list<shared_ptr<AbstractionGenerator>>("abstractions"), dead_ends.get());
-        CPFunction cp_function = get_cp_function_from_options(options);
-        vector<CostPartitioningHeuristic> cp_heuristics =
-            get_cp_heuristic_collection_generator_from_options(options).generate_cost_partitionings(
-                task_proxy, abstractions, costs, cp_function);
-        return make_shared<MaxCostPartitioningHeuristic>(
-            options,
-            move(abstractions),
-            move(cp_heuristics),
-            move(dead_ends));
+        return get_max_cp_heuristic(
+            options, get_cp_function_from_options(options));
     }
 };
 
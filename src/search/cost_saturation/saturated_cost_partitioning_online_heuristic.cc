@@ -106,7 +106,7 @@ int SaturatedCostPartitioningOnlineHeuristic::compute_heuristic(const State &anc
             cost_partitioning = compute_perim_saturated_cost_partitioning(
                 abstractions, order, remaining_costs, abstract_state_ids);
         } else {
-            cost_partitioning = cp_function(abstractions, order, remaining_costs, abstract_state_ids);
+            cost_partitioning = cp_function.compute(abstractions, order, remaining_costs, abstract_state_ids);
         }
         ++num_scps_computed;
 
@@ -22,11 +22,22 @@ const int INF = std::numeric_limits<int>::max();
 using Abstractions = std::vector<std::unique_ptr<Abstraction>>;
 using AbstractionFunctions = std::vector<std::unique_ptr<AbstractionFunction>>;
 using AbstractionGenerators = std::vector<std::shared_ptr<AbstractionGenerator>>;
-using CPFunction = std::function<CostPartitioningHeuristic(
-                                     const Abstractions &, const std::vector<int> &, std::vector<int> &, const std::vector<int> &)>;
 using CPHeuristics = std::vector<CostPartitioningHeuristic>;
 using DeadEnds = partial_state_tree::PartialStateTree;
 using Order = std::vector<int>;
+
+/*
+  A cost partitioning function is sequential if it processes the
+  abstractions one after the other in the given order, passes information to
+  later abstractions only via the remaining costs, and supports partial
+  orders.
+*/
+struct CPFunction {
+    std::function<CostPartitioningHeuristic(
+                      const Abstractions &, const std::vector<int> &,
+                      std::vector<int> &, const std::vector<int> &)> compute;
+    bool is_sequential;
+};
 }
 
 #endif
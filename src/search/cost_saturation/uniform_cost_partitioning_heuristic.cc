@@ -162,14 +162,16 @@ static CPHeuristics get_oucp_heuristics(
     vector<int> costs = task_properties::get_operator_costs(task_proxy);
     return cps_generator.generate_cost_partitionings(
         task_proxy, abstractions, costs,
-        [debug](
-            const Abstractions &abstractions_,
-            const vector<int> &order,
-            vector<int> &remaining_costs,
-            const vector<int> &) {
-            return compute_opportunistic_uniform_cost_partitioning(
-                abstractions_, order, remaining_costs, debug);
-        });
+        CPFunction{
+            [debug](
+                const Abstractions &abstractions_,
+                const vector<int> &order,
+                vector<int> &remaining_costs,
+                const vector<int> &) {
+                return compute_opportunistic_uniform_cost_partitioning(
+                    abstractions_, order, remaining_costs, debug);
+            },
+            false});
 }
 
 class UniformCostPartitioningHeuristicFeature
@@ -191,6 +193,7 @@ public:
 
         add_options_for_cost_partitioning_heuristic(*this);
         add_order_options(*this);
+        add_lookup_table_options(*this);
         add_option<bool>(
             "opportunistic",
             "recalculate uniform cost partitioning after each considered abstraction",
@@ -3,6 +3,9 @@
 #include "abstraction.h"
 #include "cost_partitioning_heuristic.h"
 
+#include "../utils/collections.h"
+#include "../utils/serialization.h"
+
 #include <algorithm>
 
 using namespace std;
@@ -23,8 +26,9 @@ UnsolvabilityHeuristic::UnsolvabilityHeuristic(
     vector<bool> has_unsolvable_states(num_abstractions, false);
     for (const auto &cp : cp_heuristics) {
         for (const auto &lookup_table : cp.lookup_tables) {
-            for (size_t state = 0; state < lookup_table.h_values.size(); ++state) {
-                if (lookup_table.h_values[state] == INF) {
+            int num_states = lookup_table.get_num_states();
+            for (int state = 0; state < num_states; ++state) {
+                if (lookup_table.get_h(state) == INF) {
                     unsolvable[lookup_table.abstraction_id][state] = true;
                     has_unsolvable_states[lookup_table.abstraction_id] = true;
                 }
@@ -45,8 +49,14 @@ UnsolvabilityHeuristic::UnsolvabilityHeuristic(
         tables.erase(
             remove_if(tables.begin(), tables.end(),
                       [](const CostPartitioningHeuristic::LookupTable &table) {
-                          return all_of(table.h_values.begin(), table.h_values.end(),
-                                        [](int h) {return h == 0 || h == INF;});
+                          int num_states = table.get_num_states();
+                          for (int state = 0; state < num_states; ++state) {
+                              int h = table.get_h(state);
+                              if (h != 0 && h != INF) {
+                                  return false;
+                              }
+                          }
+                          return true;
                       }), tables.end());
         tables.shrink_to_fit();
     }
@@ -67,4 +77,36 @@ void UnsolvabilityHeuristic::mark_useful_abstractions(
         useful_abstractions[info.abstraction_id] = true;
     }
 }
+
+void UnsolvabilityHeuristic::save(ostream &os) const {
+    utils::write_binary<int>(os, unsolvability_infos.size());
+    for (const auto &info : unsolvability_infos) {
+        utils::write_binary(os, info.abstraction_id);
+        utils::write_binary_vector(os, info.unsolvable_states);
+    }
+}
+
+void UnsolvabilityHeuristic::load(istream &is) {
+    unsolvability_infos.clear();
+    int num_infos = utils::read_binary<int>(is);
+    for (int i = 0; i < num_infos && is; ++i) {
+        int abstraction_id = utils::read_binary<int>(is);
+        vector<bool> unsolvable_states = utils::read_binary_bool_vector(is);
+        unsolvability_infos.emplace_back(abstraction_id, move(unsolvable_states));
+    }
+}
+
+bool UnsolvabilityHeuristic::fits(
+    const AbstractionFunctions &abstraction_functions) const {
+    for (const auto &info : unsolvability_infos) {
+        int id = info.abstraction_id;
+        if (!utils::in_bounds(id, abstraction_functions) ||
+            !abstraction_functions[id] ||
+            static_cast<int>(info.unsolvable_states.size()) !=
+            abstraction_functions[id]->get_num_states()) {
+            return false;
+        }
+    }
+    return true;
+}
 }
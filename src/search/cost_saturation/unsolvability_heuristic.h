@@ -3,6 +3,9 @@
 
 #include "types.h"
 
+#include <istream>
+#include <ostream>
+
 namespace cost_saturation {
 /*
   Compactly store information about unsolvable abstract states.
@@ -31,9 +34,16 @@ class UnsolvabilityHeuristic {
 
 public:
     UnsolvabilityHeuristic(const Abstractions &abstractions, CPHeuristics &cp_heuristics);
+    // Create a heuristic without information. Use load() to fill it.
+    UnsolvabilityHeuristic() = default;
 
     bool is_unsolvable(const std::vector<int> &abstract_state_ids) const;
     void mark_useful_abstractions(std::vector<bool> &useful_abstractions) const;
+
+    void save(std::ostream &os) const;
+    void load(std::istream &is);
+    // See CostPartitioningHeuristic::fits().
+    bool fits(const AbstractionFunctions &abstraction_functions) const;
 };
 }
 
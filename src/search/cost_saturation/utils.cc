@@ -4,12 +4,14 @@
 #include "abstraction_generator.h"
 #include "cost_partitioning_heuristic.h"
 #include "cost_partitioning_heuristic_collection_generator.h"
+#include "heuristic_cache.h"
 #include "max_cost_partitioning_heuristic.h"
 #include "unsolvability_heuristic.h"
 
 #include "../algorithms/partial_state_tree.h"
 #include "../plugins/plugin.h"
 #include "../task_utils/task_properties.h"
+#include "../tasks/root_task.h"
 #include "../utils/collections.h"
 #include "../utils/logging.h"
 #include "../utils/rng.h"
@@ -17,6 +19,7 @@
 
 #include <cassert>
 #include <numeric>
+#include <unordered_set>
 
 using namespace std;
 
@@ -182,9 +185,56 @@ void add_order_options(plugins::Feature &feature) {
         "maximum time in seconds for optimizing each order with hill climbing",
         "2",
         plugins::Bounds("0", "infinity"));
+    feature.add_option<int>(
+        "threads",
+        "number of threads for computing, optimizing and diversifying orders. "
+        "With threads > 1, each thread uses its own random number generator, "
+        "seeded from the random seed of this heuristic. Results are "
+        "reproducible for a fixed random seed and number of threads.",
+        "1",
+        plugins::Bounds("1", "infinity"));
     utils::add_rng_options(feature);
 }
 
+void add_lookup_table_options(plugins::Feature &feature) {
+    feature.add_option<bool>(
+        "flat_lookup_tables",
+        "store the lookup tables of all orders in one contiguous array and "
+        "compute the maximum over all orders in a single pass (uses AVX2 "
+        "gather instructions if the CPU supports them)",
+        "false");
+    feature.add_option<bool>(
+        "compress_lookup_tables",
+        "store each lookup table with the narrowest integer type (8, 16 or "
+        "32 bits) that fits its values. This lets more orders fit into "
+        "max_size. Lookup tables are decompressed again if "
+        "flat_lookup_tables=true.",
+        "false");
+    feature.add_option<bool>(
+        "incremental",
+        "compute the abstract state IDs of a successor state from the IDs of "
+        "its parent by only updating the abstractions that depend on "
+        "variables changed by the operator. This makes the heuristic "
+        "path-dependent.",
+        "false");
+}
+
+void add_cache_options(plugins::Feature &feature) {
+    feature.add_option<string>(
+        "cache_dir",
+        "directory for storing the computed heuristic. If a heuristic for the "
+        "same task and configuration is stored there, we load it instead of "
+        "computing abstractions and cost partitionings. Use the empty string "
+        "to disable caching. Options that only affect the search (e.g., "
+        "cache_dir, incremental and flat_lookup_tables) are ignored when "
+        "looking for a stored heuristic. Note that the computed heuristic "
+        "depends on the time limits (max_time, max_optimization_time and "
+        "the time limits of the abstraction generators, e.g., "
+        "hillclimbing(max_time=60)), so a stored heuristic can differ from "
+        "the heuristic that a new computation would yield.",
+        "\"\"");
+}
+
 CostPartitioningHeuristicCollectionGenerator
 get_cp_heuristic_collection_generator_from_options(const plugins::Options &opts) {
     return CostPartitioningHeuristicCollectionGenerator(
@@ -195,6 +245,8 @@ get_cp_heuristic_collection_generator_from_options(const plugins::Options &opts)
         opts.get<bool>("diversify"),
         opts.get<int>("samples"),
         opts.get<double>("max_optimization_time"),
+        opts.get<int>("threads"),
+        opts.get<bool>("compress_lookup_tables"),
         utils::parse_rng_from_options(opts));
 }
 
@@ -224,9 +276,82 @@ void add_options_for_cost_partitioning_heuristic(
 }
 
 
-shared_ptr<MaxCostPartitioningHeuristic> get_max_cp_heuristic(const plugins::Options &opts, const CPFunction &cp_function) {
+/*
+  Remove the top-level keyword arguments that don't affect the data stored
+  in the heuristic cache from the given configuration string.
+*/
+static string get_heuristic_cache_key(const string &config) {
+    static const unordered_set<string> search_only_options = {
+        "cache_dir", "cache_estimates", "description",
+        "flat_lookup_tables", "incremental", "verbosity"};
+    size_t open = config.find('(');
+    if (open == string::npos) {
+        return config;
+    }
+    vector<string> arguments;
+    size_t argument_start = open + 1;
+    int depth = 0;
+    bool in_string = false;
+    for (size_t pos = open + 1; pos < config.size(); ++pos) {
+        char c = config[pos];
+        if (in_string) {
+            in_string = (c != '"');
+        } else if (c == '"') {
+            in_string = true;
+        } else if (c == '(' || c == '[') {
+            ++depth;
+        } else if ((c == ')' || c == ']') && depth > 0) {
+            --depth;
+        } else if ((c == ',' || c == ')') && depth == 0) {
+            arguments.push_back(config.substr(argument_start, pos - argument_start));
+            argument_start = pos + 1;
+        }
+    }
+    string key = config.substr(0, open + 1);
+    string separator;
+    for (const string &argument : arguments) {
+        size_t equal_sign = argument.find('=');
+        if (argument.empty() || (equal_sign != string::npos &&
+                                 search_only_options.count(argument.substr(0, equal_sign)))) {
+            continue;
+        }
+        key += separator + argument;
+        separator = ",";
+    }
+    return key + ")";
+}
+
+shared_ptr<MaxCostPartitioningHeuristic> get_max_cp_heuristic(
+    const plugins::Options &opts, const CPFunction &cp_function) {
     shared_ptr<AbstractTask> task = opts.get<shared_ptr<AbstractTask>>("transform");
     TaskProxy task_proxy(*task);
+    string cache_dir = opts.get<string>("cache_dir");
+    if (!cache_dir.empty() &&
+        task->does_convert_ancestor_state_values(tasks::g_root_task.get())) {
+        utils::g_log << "Ignoring cache_dir since the heuristic uses a task "
+                     << "transformation that converts state values." << endl;
+        cache_dir.clear();
+    }
+    unique_ptr<HeuristicCache> cache;
+    if (!cache_dir.empty()) {
+        cache = utils::make_unique_ptr<HeuristicCache>(
+            cache_dir, task_proxy,
+            get_heuristic_cache_key(opts.get_unparsed_config()));
+        AbstractionFunctions abstraction_functions;
+        CPHeuristics cp_heuristics;
+        UnsolvabilityHeuristic unsolvability_heuristic;
+        unique_ptr<DeadEnds> dead_ends = utils::make_unique_ptr<DeadEnds>();
+        if (cache->load(abstraction_functions, cp_heuristics,
+                        unsolvability_heuristic, *dead_ends)) {
+            return make_shared<MaxCostPartitioningHeuristic>(
+                opts,
+                move(abstraction_functions),
+                move(cp_heuristics),
+                move(unsolvability_heuristic),
+                move(dead_ends));
+        }
+    }
+
     vector<int> costs = task_properties::get_operator_costs(task_proxy);
     unique_ptr<DeadEnds> dead_ends = utils::make_unique_ptr<DeadEnds>();
     Abstractions abstractions = generate_abstractions(
@@ -234,10 +359,24 @@ shared_ptr<MaxCostPartitioningHeuristic> get_max_cp_heuristic(const plugins::Opt
     vector<CostPartitioningHeuristic> cp_heuristics =
         get_cp_heuristic_collection_generator_from_options(opts).generate_cost_partitionings(
             task_proxy, abstractions, costs, cp_function);
+    if (!cache) {
+        return make_shared<MaxCostPartitioningHeuristic>(
+            opts,
+            move(abstractions),
+            move(cp_heuristics),
+            move(dead_ends));
+    }
+
+    UnsolvabilityHeuristic unsolvability_heuristic(abstractions, cp_heuristics);
+    AbstractionFunctions abstraction_functions =
+        extract_abstraction_functions_from_useful_abstractions(
+            cp_heuristics, &unsolvability_heuristic, abstractions);
+    cache->save(abstraction_functions, cp_heuristics, unsolvability_heuristic, *dead_ends);
     return make_shared<MaxCostPartitioningHeuristic>(
         opts,
-        move(abstractions),
+        move(abstraction_functions),
         move(cp_heuristics),
+        move(unsolvability_heuristic),
         move(dead_ends));
 }
 }
@@ -60,11 +60,38 @@ std::vector<int> get_abstract_state_ids(
     return abstract_state_ids;
 }
 
+/*
+  Compute the abstract state IDs of a batch of states. The result holds one
+  vector of abstract state IDs per state. Each abstraction handles the whole
+  batch at once, which avoids a virtual call per state and abstraction.
+*/
+template<typename AbstractionsOrFunction>
+std::vector<std::vector<int>> get_abstract_state_ids(
+    const std::vector<AbstractionsOrFunction> &abstractions,
+    const std::vector<State> &states) {
+    int num_states = states.size();
+    int num_abstractions = abstractions.size();
+    std::vector<std::vector<int>> abstract_state_ids_by_state(
+        num_states, std::vector<int>(num_abstractions, -1));
+    std::vector<int> abstract_state_ids;
+    for (int i = 0; i < num_abstractions; ++i) {
+        if (abstractions[i]) {
+            abstractions[i]->get_abstract_state_ids(states, abstract_state_ids);
+            for (int j = 0; j < num_states; ++j) {
+                abstract_state_ids_by_state[j][i] = abstract_state_ids[j];
+            }
+        }
+    }
+    return abstract_state_ids_by_state;
+}
+
 extern void reduce_costs(
     std::vector<int> &remaining_costs, const std::vector<int> &saturated_costs);
 
 
 extern void add_order_options(plugins::Feature &feature);
+extern void add_lookup_table_options(plugins::Feature &feature);
+extern void add_cache_options(plugins::Feature &feature);
 extern void add_options_for_cost_partitioning_heuristic(plugins::Feature &feature, bool consistent = true);
 extern std::shared_ptr<MaxCostPartitioningHeuristic> get_max_cp_heuristic(
     const plugins::Options &opts, const CPFunction &cp_function);
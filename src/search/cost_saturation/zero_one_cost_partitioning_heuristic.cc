@@ -15,7 +15,8 @@ static CostPartitioningHeuristic compute_zero_one_cost_partitioning(
     const vector<int> &order,
     vector<int> &remaining_costs,
     const vector<int> &) {
-    assert(abstractions.size() == order.size());
+    // Sequential cost partitionings also support partial orders.
+    assert(order.size() <= abstractions.size());
     bool debug = false;
 
     CostPartitioningHeuristic cp_heuristic;
@@ -44,11 +45,14 @@ public:
         document_title("Greedy zero-one cost partitioning");
         add_options_for_cost_partitioning_heuristic(*this);
         add_order_options(*this);
+        add_lookup_table_options(*this);
+        add_cache_options(*this);
     }
 
     virtual shared_ptr<MaxCostPartitioningHeuristic> create_component(
         const plugins::Options &options, const utils::Context &) const override {
-        return get_max_cp_heuristic(options, compute_zero_one_cost_partitioning);
+        return get_max_cp_heuristic(
+            options, CPFunction{compute_zero_one_cost_partitioning, true});
     }
 };
 
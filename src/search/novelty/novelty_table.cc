@@ -3,6 +3,8 @@
 #include "../task_utils/task_properties.h"
 #include "../utils/logging.h"
 
+#include <bit>
+
 using namespace std;
 
 namespace novelty {
@@ -57,33 +59,80 @@ NoveltyTable::NoveltyTable(
     const TaskProxy &task_proxy, int width, const shared_ptr<FactIndexer> &fact_indexer_)
     : width(width),
       fact_indexer(fact_indexer_),
-      compute_novelty_timer(false) {
+      num_novelty_computations(0) {
     if (!fact_indexer) {
         cout << "Create fact indexer." << endl;
         fact_indexer = make_shared<FactIndexer>(task_proxy);
     }
+    words_per_row = (fact_indexer->get_num_facts() + 63) / 64;
+    state_facts.assign(words_per_row, 0);
     reset();
 }
 
+void NoveltyTable::set_state_facts(const State &state) {
+    assert(state_fact_ids.empty() && nonzero_words.empty());
+    for (FactProxy fact_proxy : state) {
+        int fact_id = fact_indexer->get_fact_id(fact_proxy.get_pair());
+        state_fact_ids.push_back(fact_id);
+        uint64_t &word = state_facts[fact_id / 64];
+        if (!word) {
+            nonzero_words.push_back(fact_id / 64);
+        }
+        word |= uint64_t(1) << (fact_id % 64);
+    }
+}
+
+void NoveltyTable::clear_state_facts() {
+    for (int word : nonzero_words) {
+        state_facts[word] = 0;
+    }
+    state_fact_ids.clear();
+    nonzero_words.clear();
+}
+
+bool NoveltyTable::update_row(
+    int fact_id, int same_var_fact_id, bool update_other_rows) {
+    uint64_t *row = get_row(fact_id);
+    int same_var_word = same_var_fact_id / 64;
+    uint64_t same_var_mask = ~(uint64_t(1) << (same_var_fact_id % 64));
+    bool novel = false;
+    for (int word : nonzero_words) {
+        uint64_t new_bits = state_facts[word] & ~row[word];
+        if (word == same_var_word) {
+            new_bits &= same_var_mask;
+        }
+        if (new_bits) {
+            novel = true;
+            row[word] |= new_bits;
+            if (update_other_rows) {
+                // Keep the matrix symmetric.
+                uint64_t fact_bit = uint64_t(1) << (fact_id % 64);
+                while (new_bits) {
+                    int other_fact_id = word * 64 + countr_zero(new_bits);
+                    get_row(other_fact_id)[fact_id / 64] |= fact_bit;
+                    new_bits &= new_bits - 1;
+                }
+            }
+        }
+    }
+    return novel;
+}
+
 int NoveltyTable::compute_novelty_and_update_table(const State &state) {
-    compute_novelty_timer.resume();
-    int num_vars = state.size();
+    ++num_novelty_computations;
     int novelty = UNKNOWN_NOVELTY;
 
     // Check for novelty 2.
     if (width == 2) {
-        for (int var1 = 0; var1 < num_vars; ++var1) {
-            FactPair fact1 = state[var1].get_pair();
-            for (int var2 = var1 + 1; var2 < num_vars; ++var2) {
-                FactPair fact2 = state[var2].get_pair();
-                int pair_id = fact_indexer->get_pair_id(fact1, fact2);
-                bool seen = seen_fact_pairs[pair_id];
-                if (!seen) {
-                    novelty = 2;
-                    seen_fact_pairs[pair_id] = true;
-                }
+        set_state_facts(state);
+        /* Since we update the rows of all state facts, the matrix stays
+           symmetric without updating other rows explicitly. */
+        for (int fact_id : state_fact_ids) {
+            if (update_row(fact_id, fact_id, false)) {
+                novelty = 2;
             }
         }
+        clear_state_facts();
     }
 
     // Check for novelty 1.
@@ -96,33 +145,26 @@ int NoveltyTable::compute_novelty_and_update_table(const State &state) {
         }
     }
 
-    compute_novelty_timer.stop();
     return novelty;
 }
 
 int NoveltyTable::compute_novelty_and_update_table(
     const OperatorProxy &op, const State &succ_state) {
-    compute_novelty_timer.resume();
+    ++num_novelty_computations;
     int novelty = UNKNOWN_NOVELTY;
 
-    // Check for novelty 2.
+    // Check for novelty 2. Only pairs with an effect fact can be new.
     if (width == 2) {
-        int num_vars = succ_state.size();
+        set_state_facts(succ_state);
         for (EffectProxy effect : op.get_effects()) {
-            FactPair fact1 = effect.get_fact().get_pair();
-            for (int var2 = 0; var2 < num_vars; ++var2) {
-                if (fact1.var == var2) {
-                    continue;
-                }
-                FactPair fact2 = succ_state[var2].get_pair();
-                int pair_id = fact_indexer->get_pair_id(fact1, fact2);
-                bool seen = seen_fact_pairs[pair_id];
-                if (!seen) {
-                    novelty = 2;
-                    seen_fact_pairs[pair_id] = true;
-                }
+            FactPair fact = effect.get_fact().get_pair();
+            int fact_id = fact_indexer->get_fact_id(fact);
+            int same_var_fact_id = state_fact_ids[fact.var];
+            if (update_row(fact_id, same_var_fact_id, true)) {
+                novelty = 2;
             }
         }
+        clear_state_facts();
     }
 
     // Check for novelty 1.
@@ -135,14 +177,14 @@ int NoveltyTable::compute_novelty_and_update_table(
         }
     }
 
-    compute_novelty_timer.stop();
     return novelty;
 }
 
 void NoveltyTable::reset() {
     seen_facts.assign(fact_indexer->get_num_facts(), false);
     if (width == 2) {
-        seen_fact_pairs.assign(fact_indexer->get_num_pairs(), false);
+        seen_fact_pairs.assign(
+            static_cast<size_t>(fact_indexer->get_num_facts()) * words_per_row, 0);
     }
 }
 
@@ -158,6 +200,6 @@ void NoveltyTable::dump_state_and_novelty(const State &state, int novelty) const
 }
 
 void NoveltyTable::print_statistics() const {
-    utils::g_log << "Time for computing novelty: " << compute_novelty_timer << endl;
+    utils::g_log << "Novelty computations: " << num_novelty_computations << endl;
 }
 }
@@ -3,9 +3,8 @@
 
 #include "../task_proxy.h"
 
-#include "../utils/timer.h"
-
 #include <cassert>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -49,14 +48,49 @@ public:
     }
 };
 
+/*
+  For width 2, we store the seen fact pairs in a symmetric bit matrix with one
+  row per fact. Rows are padded to full 64-bit words. Bit f2 of row f1 is set
+  iff f1 and f2 belong to different variables and have occurred together in a
+  state. For a given state, we compute the set of its facts as a bitset and
+  then test and update each row of the state's facts with one AND-NOT per
+  word, skipping the words that contain no fact of the state.
+
+  Compared to testing each fact pair individually, this needs twice as many
+  bits, but only min(#vars, #words per row) word operations per fact instead
+  of #vars scattered bit accesses.
+*/
 class NoveltyTable {
     const int width;
 
     std::shared_ptr<FactIndexer> fact_indexer;
     std::vector<bool> seen_facts;
-    std::vector<bool> seen_fact_pairs;
-
-    utils::Timer compute_novelty_timer;
+    int words_per_row;
+    std::vector<uint64_t> seen_fact_pairs;
+
+    // Scratch data for the facts of the current state.
+    std::vector<uint64_t> state_facts;
+    std::vector<int> state_fact_ids;
+    std::vector<int> nonzero_words;
+
+    /*
+      We only count novelty computations, since timing each call with our
+      CPU timers would take longer than the computation itself.
+    */
+    int64_t num_novelty_computations;
+
+    void set_state_facts(const State &state);
+    void clear_state_facts();
+    /*
+      Mark all pairs of fact_id and the state facts as seen and return true
+      if at least one of them was unseen. Pairs with the fact of the same
+      variable (given by same_var_fact_id) are ignored.
+    */
+    bool update_row(int fact_id, int same_var_fact_id, bool update_other_rows);
+
+    uint64_t *get_row(int fact_id) {
+        return &seen_fact_pairs[static_cast<size_t>(fact_id) * words_per_row];
+    }
 
     void dump_state_and_novelty(const State &state, int novelty) const;
 
@@ -0,0 +1,447 @@
+#include "bucket_open_list.h"
+
+#include "../evaluator.h"
+#include "../open_list.h"
+
+#include "../plugins/plugin.h"
+#include "../utils/memory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace bucket_open_list {
+/*
+  Storage for the entries of all buckets of an open list. The storage is
+  divided into chunks of CHUNK_SIZE entries. Each bucket is a linked list of
+  chunks. Chunks of emptied buckets are reused, so empty buckets need no
+  memory and we rarely allocate memory after the open list has grown.
+*/
+template<class Entry>
+class ChunkPool {
+    vector<Entry> entries;
+    vector<int> next_chunk;
+    vector<int> free_chunks;
+
+public:
+    static constexpr int CHUNK_SIZE = 64;
+    static constexpr int NO_CHUNK = -1;
+
+    // Entry types have no default value, so we fill new chunks with entry.
+    int allocate(const Entry &entry) {
+        int chunk;
+        if (free_chunks.empty()) {
+            chunk = next_chunk.size();
+            entries.resize(entries.size() + CHUNK_SIZE, entry);
+            next_chunk.push_back(NO_CHUNK);
+        } else {
+            chunk = free_chunks.back();
+            free_chunks.pop_back();
+            next_chunk[chunk] = NO_CHUNK;
+        }
+        return chunk;
+    }
+
+    void release(int chunk) {
+        free_chunks.push_back(chunk);
+    }
+
+    Entry &get_entry(int chunk, int pos) {
+        return entries[chunk * CHUNK_SIZE + pos];
+    }
+
+    int get_next_chunk(int chunk) const {
+        return next_chunk[chunk];
+    }
+
+    void set_next_chunk(int chunk, int next) {
+        next_chunk[chunk] = next;
+    }
+
+    void clear() {
+        entries.clear();
+        next_chunk.clear();
+        free_chunks.clear();
+    }
+};
+
+// FIFO queue of entries that lives in a ChunkPool.
+template<class Entry>
+class Bucket {
+    using Pool = ChunkPool<Entry>;
+
+    int head_chunk = Pool::NO_CHUNK;
+    int tail_chunk = Pool::NO_CHUNK;
+    int head_pos = 0;
+    int tail_pos = 0;
+
+public:
+    bool empty() const {
+        return head_chunk == Pool::NO_CHUNK;
+    }
+
+    void push(const Entry &entry, Pool &pool) {
+        if (empty()) {
+            head_chunk = tail_chunk = pool.allocate(entry);
+            head_pos = tail_pos = 0;
+        } else if (tail_pos == Pool::CHUNK_SIZE) {
+            int chunk = pool.allocate(entry);
+            pool.set_next_chunk(tail_chunk, chunk);
+            tail_chunk = chunk;
+            tail_pos = 0;
+        }
+        pool.get_entry(tail_chunk, tail_pos++) = entry;
+    }
+
+    Entry pop(Pool &pool) {
+        assert(!empty());
+        Entry entry = pool.get_entry(head_chunk, head_pos++);
+        if (head_chunk == tail_chunk && head_pos == tail_pos) {
+            pool.release(head_chunk);
+            head_chunk = tail_chunk = Pool::NO_CHUNK;
+        } else if (head_pos == Pool::CHUNK_SIZE) {
+            int next = pool.get_next_chunk(head_chunk);
+            pool.release(head_chunk);
+            head_chunk = next;
+            head_pos = 0;
+        }
+        return entry;
+    }
+};
+
+/*
+  Open list that orders entries by the value of the first evaluator and
+  breaks ties by the value of the optional second evaluator and then in FIFO
+  order. This is the same order as the tie-breaking open list, but insertion
+  and removal take amortized constant time for densely distributed keys.
+
+  Dense keys (f, h) live in a two-level bucket array: f_buckets[f -
+  f_offset].buckets[h]. Both levels keep a pointer to their smallest
+  non-empty bucket, which only moves forward during removals. We release
+  the h buckets of each f row once min_f passes it and drop passed rows from
+  the front of the array, so the array covers a window of f values that
+  follows the search frontier.
+
+  A key only goes into the array if the array then has at most
+  max_buckets_per_entry buckets per stored entry (or at most
+  MIN_DENSE_BUCKETS buckets). All other keys, including infinite values,
+  go into a map. Growing a row moves the entries of the map keys it covers
+  into the new buckets, so each key is stored in exactly one place.
+*/
+template<class Entry>
+class BucketOpenList : public OpenList<Entry> {
+    using Key = pair<int, int>;
+
+    struct FBucket {
+        vector<Bucket<Entry>> buckets;
+        // No bucket below min_h holds entries.
+        int min_h = 0;
+        int num_nonempty_buckets = 0;
+    };
+
+    static constexpr int MIN_DENSE_BUCKETS = 1024;
+
+    ChunkPool<Entry> chunk_pool;
+    vector<FBucket> f_buckets;
+    // f value of f_buckets[0].
+    int f_offset;
+    // No f bucket below min_f holds entries.
+    int min_f;
+    // Number of f rows plus the number of h buckets in all rows.
+    int64_t num_dense_buckets;
+    map<Key, Bucket<Entry>> sparse_buckets;
+    int size;
+
+    vector<shared_ptr<Evaluator>> evaluators;
+    const int max_buckets_per_entry;
+    /*
+      If allow_unsafe_pruning is true, we ignore (don't insert) states
+      which the first evaluator considers a dead end, even if it is
+      not a safe heuristic.
+    */
+    bool allow_unsafe_pruning;
+
+    bool try_dense_insertion(const Key &key, const Entry &entry);
+    void release_row(FBucket &f_bucket);
+    // Return the smallest key in the bucket arrays or (-1, -1) if they are empty.
+    Key find_min_dense_key();
+
+protected:
+    virtual void do_insertion(EvaluationContext &eval_context,
+                              const Entry &entry) override;
+
+public:
+    explicit BucketOpenList(const plugins::Options &opts);
+    virtual ~BucketOpenList() override = default;
+
+    virtual Entry remove_min() override;
+    virtual bool empty() const override;
+    virtual void clear() override;
+    virtual void get_path_dependent_evaluators(set<Evaluator *> &evals) override;
+    virtual bool is_dead_end(
+        EvaluationContext &eval_context) const override;
+    virtual bool is_reliable_dead_end(
+        EvaluationContext &eval_context) const override;
+};
+
+
+template<class Entry>
+BucketOpenList<Entry>::BucketOpenList(const plugins::Options &opts)
+    : OpenList<Entry>(opts.get<bool>("pref_only")),
+      f_offset(0),
+      min_f(0),
+      num_dense_buckets(0),
+      size(0),
+      evaluators(opts.get_list<shared_ptr<Evaluator>>("evals")),
+      max_buckets_per_entry(opts.get<int>("max_buckets_per_entry")),
+      allow_unsafe_pruning(opts.get<bool>("unsafe_pruning")) {
+}
+
+template<class Entry>
+bool BucketOpenList<Entry>::try_dense_insertion(const Key &key, const Entry &entry) {
+    auto [f, h] = key;
+    if (max_buckets_per_entry == 0 || f < 0 || h < 0 ||
+        f == EvaluationResult::INFTY || h == EvaluationResult::INFTY) {
+        return false;
+    }
+
+    // Compute how many rows and buckets the array needs for the key.
+    int64_t num_rows = f_buckets.size();
+    int64_t first_f = f_buckets.empty() ? f : min(f_offset, f);
+    int64_t end_f = f_buckets.empty() ? f + 1 : max<int64_t>(f_offset + num_rows, f + 1);
+    int64_t num_new_rows = (end_f - first_f) - num_rows;
+    int64_t row_size = 0;
+    if (f >= f_offset && f < f_offset + num_rows) {
+        row_size = f_buckets[f - f_offset].buckets.size();
+    }
+    int64_t num_new_buckets = num_new_rows + max<int64_t>(0, h + 1 - row_size);
+    if (num_new_buckets > 0) {
+        int64_t max_buckets = max<int64_t>(
+            MIN_DENSE_BUCKETS,
+            static_cast<int64_t>(max_buckets_per_entry) * (size + 1));
+        if (num_dense_buckets + num_new_buckets > max_buckets) {
+            return false;
+        }
+    }
+
+    if (f_buckets.empty()) {
+        f_offset = min_f = f;
+    }
+    if (f < f_offset) {
+        f_buckets.insert(f_buckets.begin(), f_offset - f, FBucket());
+        f_offset = f;
+    }
+    if (f - f_offset >= static_cast<int>(f_buckets.size())) {
+        f_buckets.resize(f - f_offset + 1);
+    }
+    num_dense_buckets += num_new_buckets;
+    FBucket &f_bucket = f_buckets[f - f_offset];
+    int old_row_size = f_bucket.buckets.size();
+    if (h >= old_row_size) {
+        f_bucket.buckets.resize(h + 1);
+        // Move the map keys that the row covers now into their buckets.
+        auto it = sparse_buckets.lower_bound(Key(f, old_row_size));
+        while (it != sparse_buckets.end() && it->first.first == f &&
+               it->first.second <= h) {
+            int moved_h = it->first.second;
+            if (f_bucket.num_nonempty_buckets == 0 || moved_h < f_bucket.min_h) {
+                f_bucket.min_h = moved_h;
+            }
+            f_bucket.buckets[moved_h] = it->second;
+            ++f_bucket.num_nonempty_buckets;
+            it = sparse_buckets.erase(it);
+        }
+    }
+    Bucket<Entry> &bucket = f_bucket.buckets[h];
+    if (bucket.empty()) {
+        if (f_bucket.num_nonempty_buckets == 0 || h < f_bucket.min_h) {
+            f_bucket.min_h = h;
+        }
+        ++f_bucket.num_nonempty_buckets;
+    }
+    min_f = min(min_f, f);
+    bucket.push(entry, chunk_pool);
+    return true;
+}
+
+template<class Entry>
+void BucketOpenList<Entry>::do_insertion(
+    EvaluationContext &eval_context, const Entry &entry) {
+    Key key(eval_context.get_evaluator_value_or_infinity(evaluators[0].get()), 0);
+    if (evaluators.size() == 2) {
+        key.second = eval_context.get_evaluator_value_or_infinity(evaluators[1].get());
+    }
+    if (!try_dense_insertion(key, entry)) {
+        sparse_buckets[key].push(entry, chunk_pool);
+    }
+    ++size;
+}
+
+template<class Entry>
+void BucketOpenList<Entry>::release_row(FBucket &f_bucket) {
+    assert(f_bucket.num_nonempty_buckets == 0);
+    num_dense_buckets -= f_bucket.buckets.size();
+    vector<Bucket<Entry>>().swap(f_bucket.buckets);
+}
+
+template<class Entry>
+typename BucketOpenList<Entry>::Key BucketOpenList<Entry>::find_min_dense_key() {
+    int end_f = f_offset + f_buckets.size();
+    while (min_f < end_f && f_buckets[min_f - f_offset].num_nonempty_buckets == 0) {
+        release_row(f_buckets[min_f - f_offset]);
+        ++min_f;
+    }
+    if (min_f == end_f) {
+        f_buckets.clear();
+        f_offset = min_f;
+        num_dense_buckets = 0;
+        return Key(-1, -1);
+    }
+    // Drop the passed rows once they make up half of the array.
+    int num_passed_rows = min_f - f_offset;
+    if (2 * num_passed_rows >= static_cast<int>(f_buckets.size())) {
+        f_buckets.erase(f_buckets.begin(), f_buckets.begin() + num_passed_rows);
+        num_dense_buckets -= num_passed_rows;
+        f_offset = min_f;
+    }
+    FBucket &f_bucket = f_buckets[min_f - f_offset];
+    while (f_bucket.buckets[f_bucket.min_h].empty()) {
+        ++f_bucket.min_h;
+    }
+    return Key(min_f, f_bucket.min_h);
+}
+
+template<class Entry>
+Entry BucketOpenList<Entry>::remove_min() {
+    assert(size > 0);
+    --size;
+    Key dense_key = find_min_dense_key();
+    if (dense_key.first != -1 &&
+        (sparse_buckets.empty() || dense_key < sparse_buckets.begin()->first)) {
+        FBucket &f_bucket = f_buckets[dense_key.first - f_offset];
+        Bucket<Entry> &bucket = f_bucket.buckets[dense_key.second];
+        Entry result = bucket.pop(chunk_pool);
+        if (bucket.empty()) {
+            --f_bucket.num_nonempty_buckets;
+        }
+        return result;
+    }
+    auto it = sparse_buckets.begin();
+    assert(it != sparse_buckets.end());
+    Entry result = it->second.pop(chunk_pool);
+    if (it->second.empty())
+        sparse_buckets.erase(it);
+    return result;
+}
+
+template<class Entry>
+bool BucketOpenList<Entry>::empty() const {
+    return size == 0;
+}
+
+template<class Entry>
+void BucketOpenList<Entry>::clear() {
+    chunk_pool.clear();
+    f_buckets.clear();
+    f_offset = 0;
+    min_f = 0;
+    num_dense_buckets = 0;
+    sparse_buckets.clear();
+    size = 0;
+}
+
+template<class Entry>
+void BucketOpenList<Entry>::get_path_dependent_evaluators(
+    set<Evaluator *> &evals) {
+    for (const shared_ptr<Evaluator> &evaluator : evaluators)
+        evaluator->get_path_dependent_evaluators(evals);
+}
+
+template<class Entry>
+bool BucketOpenList<Entry>::is_dead_end(
+    EvaluationContext &eval_context) const {
+    // Use the same rules as the tie-breaking open list.
+    if (is_reliable_dead_end(eval_context))
+        return true;
+    if (allow_unsafe_pruning &&
+        eval_context.is_evaluator_value_infinite(evaluators[0].get()))
+        return true;
+    for (const shared_ptr<Evaluator> &evaluator : evaluators)
+        if (!eval_context.is_evaluator_value_infinite(evaluator.get()))
+            return false;
+    return true;
+}
+
+template<class Entry>
+bool BucketOpenList<Entry>::is_reliable_dead_end(
+    EvaluationContext &eval_context) const {
+    for (const shared_ptr<Evaluator> &evaluator : evaluators)
+        if (eval_context.is_evaluator_value_infinite(evaluator.get()) &&
+            evaluator->dead_ends_are_reliable())
+            return true;
+    return false;
+}
+
+BucketOpenListFactory::BucketOpenListFactory(const plugins::Options &options)
+    : options(options) {
+}
+
+unique_ptr<StateOpenList>
+BucketOpenListFactory::create_state_open_list() {
+    return utils::make_unique_ptr<BucketOpenList<StateOpenListEntry>>(options);
+}
+
+unique_ptr<EdgeOpenList>
+BucketOpenListFactory::create_edge_open_list() {
+    return utils::make_unique_ptr<BucketOpenList<EdgeOpenListEntry>>(options);
+}
+
+class BucketOpenListFeature : public plugins::TypedFeature<OpenListFactory, BucketOpenListFactory> {
+public:
+    BucketOpenListFeature() : TypedFeature("bucket") {
+        document_title("Bucket-based open list");
+        document_synopsis(
+            "Selects the entry with the lowest value of the first evaluator, "
+            "breaks ties by the value of the optional second evaluator and "
+            "then in FIFO order. The order is the same as for the tie-breaking "
+            "open list, but insertions and removals take amortized constant "
+            "time if the values are densely distributed integers. This makes "
+            "the open list well suited for A* (use evals=[f, h]).");
+
+        add_list_option<shared_ptr<Evaluator>>(
+            "evals", "one or two evaluators (primary key and tie-breaker)");
+        add_option<bool>(
+            "pref_only",
+            "insert only nodes generated by preferred operators", "false");
+        add_option<bool>(
+            "unsafe_pruning",
+            "allow unsafe pruning when the main evaluator regards a state a dead end",
+            "true");
+        add_option<int>(
+            "max_buckets_per_entry",
+            "store an entry in the bucket arrays only if they then have at "
+            "most this many buckets per entry in the open list (or at most "
+            "1024 buckets in total) and in a map otherwise. This bounds the "
+            "memory for the bucket arrays by a constant factor of the "
+            "largest number of stored entries. Use 0 to store all entries in "
+            "the map.",
+            "4",
+            plugins::Bounds("0", "infinity"));
+    }
+
+    virtual shared_ptr<BucketOpenListFactory> create_component(const plugins::Options &options, const utils::Context &context) const override {
+        plugins::verify_list_non_empty<shared_ptr<Evaluator>>(context, options, "evals");
+        if (options.get_list<shared_ptr<Evaluator>>("evals").size() > 2) {
+            context.error("Bucket open lists support at most two evaluators.");
+        }
+        return make_shared<BucketOpenListFactory>(options);
+    }
+};
+
+static plugins::FeaturePlugin<BucketOpenListFeature> _plugin;
+}
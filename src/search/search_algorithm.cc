@@ -47,7 +47,7 @@ SearchAlgorithm::SearchAlgorithm(const plugins::Options &opts)
       task(tasks::g_root_task),
       task_proxy(*task),
       log(utils::get_log_from_options(opts)),
-      state_registry(task_proxy),
+      state_registry(task_proxy, opts.get<bool>("state_fingerprints")),
       successor_generator(get_successor_generator(task_proxy, log)),
       search_space(state_registry, log),
       statistics(log),
@@ -148,6 +148,13 @@ void SearchAlgorithm::add_options_to_feature(plugins::Feature &feature) {
         "experiments. Timed-out searches are treated as failed searches, "
         "just like incomplete search algorithms that exhaust their search space.",
         "infinity");
+    feature.add_option<bool>(
+        "state_fingerprints",
+        "store a 32-bit fingerprint of each state in the hash set used for "
+        "duplicate detection. This doubles the memory of the hash set, but "
+        "avoids most accesses to the state data when comparing and rehashing "
+        "entries, which pays off for tasks with large states.",
+        "false");
     utils::add_log_options_to_feature(feature);
 }
 
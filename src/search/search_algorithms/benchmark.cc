@@ -0,0 +1,71 @@
+#include "benchmark.h"
+
+#include "../plugins/plugin.h"
+#include "../task_utils/successor_generator.h"
+#include "../utils/logging.h"
+#include "../utils/system.h"
+
+#include <deque>
+
+using namespace std;
+
+namespace benchmark {
+Benchmark::Benchmark(const plugins::Options &opts, const string &name)
+    : SearchAlgorithm(opts),
+      name(name) {
+}
+
+void Benchmark::initialize() {
+    log << "Benchmarking " << name << endl;
+}
+
+void Benchmark::collect_states(
+    int max_states, const TransitionCallback &add_transition) {
+    deque<StateID> queue;
+    queue.push_back(state_registry.get_initial_state().get_id());
+    vector<OperatorID> applicable_ops;
+    while (!queue.empty() && static_cast<int>(state_registry.size()) < max_states) {
+        State state = state_registry.lookup_state(queue.front());
+        queue.pop_front();
+        applicable_ops.clear();
+        successor_generator.generate_applicable_ops(state, applicable_ops);
+        for (OperatorID op_id : applicable_ops) {
+            int num_states_before = state_registry.size();
+            State succ_state = state_registry.get_successor_state(
+                state, task_proxy.get_operators()[op_id]);
+            if (static_cast<int>(state_registry.size()) > num_states_before) {
+                queue.push_back(succ_state.get_id());
+                if (add_transition) {
+                    add_transition(state, op_id, succ_state);
+                }
+            }
+        }
+    }
+    log << "Collected " << state_registry.size() << " states." << endl;
+}
+
+void Benchmark::check(bool condition, const string &error_message) const {
+    if (!condition) {
+        cerr << error_message << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+    }
+}
+
+SearchStatus Benchmark::step() {
+    run_benchmark();
+    return FAILED;
+}
+
+void Benchmark::print_statistics() const {
+    statistics.print_detailed_statistics();
+}
+
+void add_benchmark_options_to_feature(plugins::Feature &feature) {
+    SearchAlgorithm::add_options_to_feature(feature);
+    feature.document_note(
+        "Benchmark",
+        "This is a benchmark for developers. It doesn't search for a plan and "
+        "is only available if the planner is compiled with the CMake option "
+        "BUILD_BENCHMARKS.");
+}
+}
@@ -0,0 +1,51 @@
+#ifndef SEARCH_ALGORITHMS_BENCHMARK_H
+#define SEARCH_ALGORITHMS_BENCHMARK_H
+
+#include "../search_algorithm.h"
+
+#include <functional>
+#include <string>
+
+namespace benchmark {
+/*
+  Base class for benchmarks that compare the running time of two
+  implementations of a data structure on the input task. Benchmarks don't
+  search for a plan: step() runs the benchmark once and returns FAILED.
+
+  The benchmarks are only compiled if the CMake option BUILD_BENCHMARKS is
+  set.
+*/
+class Benchmark : public SearchAlgorithm {
+    const std::string name;
+
+protected:
+    using TransitionCallback = std::function<
+        void (const State &parent, OperatorID op_id, const State &succ)>;
+
+    /*
+      Register reachable states in state_registry with a breadth-first
+      search until the registry holds at least max_states states or the
+      search space is exhausted. Call add_transition for each transition
+      that reaches a new state.
+    */
+    void collect_states(
+        int max_states, const TransitionCallback &add_transition = nullptr);
+
+    // Abort with an error if the two implementations disagree.
+    void check(bool condition, const std::string &error_message) const;
+
+    virtual void run_benchmark() = 0;
+
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+
+public:
+    Benchmark(const plugins::Options &opts, const std::string &name);
+
+    virtual void print_statistics() const override;
+};
+
+extern void add_benchmark_options_to_feature(plugins::Feature &feature);
+}
+
+#endif
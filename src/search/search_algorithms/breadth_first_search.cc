@@ -145,6 +145,7 @@ public:
         opts.set<OperatorCost>("cost_type", ONE);
         opts.set<int>("bound", numeric_limits<int>::max());
         opts.set<double>("max_time", numeric_limits<double>::infinity());
+        opts.set<bool>("state_fingerprints", false);
         return make_shared<BreadthFirstSearch>(opts);
     }
 };
@@ -0,0 +1,128 @@
+#include "concurrent_registry_benchmark.h"
+
+#include "../concurrent_state_registry.h"
+
+#include "../plugins/plugin.h"
+#include "../utils/logging.h"
+#include "../utils/parallel.h"
+
+#include <chrono>
+
+using namespace std;
+
+namespace concurrent_registry_benchmark {
+/*
+  Our timers measure the CPU time of the process, which grows with the number
+  of busy threads. We are interested in throughput, so we use wall-clock time.
+*/
+static double get_elapsed_seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+ConcurrentRegistryBenchmark::ConcurrentRegistryBenchmark(const plugins::Options &opts)
+    : Benchmark(opts, "concurrent state registry"),
+      thread_counts(opts.get_list<int>("threads")),
+      max_states(opts.get<int>("max_states")) {
+    for (int num_threads : thread_counts) {
+        if (num_threads < 1) {
+            cerr << "Thread counts must be positive." << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+        }
+    }
+}
+
+vector<PackedStateBin> ConcurrentRegistryBenchmark::get_state_buffers() const {
+    int num_bins = state_registry.get_state_packer().get_num_bins();
+    int num_states = min(static_cast<int>(state_registry.size()), max_states);
+    vector<PackedStateBin> buffers;
+    buffers.reserve(num_states * num_bins);
+    int num_collected = 0;
+    for (StateID id : state_registry) {
+        if (num_collected == num_states) {
+            break;
+        }
+        const PackedStateBin *buffer = state_registry.lookup_state(id).get_buffer();
+        buffers.insert(buffers.end(), buffer, buffer + num_bins);
+        ++num_collected;
+    }
+    return buffers;
+}
+
+void ConcurrentRegistryBenchmark::run_sequential_baseline(
+    const vector<PackedStateBin> &buffers) {
+    StateRegistry registry(task_proxy);
+    int num_bins = registry.get_state_packer().get_num_bins();
+    int num_states = buffers.size() / num_bins;
+    auto start = chrono::steady_clock::now();
+    for (int repetition = 0; repetition < 2; ++repetition) {
+        for (int i = 0; i < num_states; ++i) {
+            registry.register_state(&buffers[i * num_bins]);
+        }
+    }
+    double seconds = get_elapsed_seconds(start);
+    log << "StateRegistry: " << 2 * num_states << " insertions, "
+        << registry.size() << " registered states, " << seconds << "s, "
+        << 2 * num_states / seconds << " insertions/s" << endl;
+}
+
+void ConcurrentRegistryBenchmark::run_concurrent(
+    const vector<PackedStateBin> &buffers, int num_threads) {
+    ConcurrentStateRegistry registry(task_proxy, num_threads);
+    int num_bins = registry.get_bins_per_state();
+    int num_states = buffers.size() / num_bins;
+    auto insert_chunk = [&](int chunk) {
+            int begin = static_cast<long long>(num_states) * chunk / num_threads;
+            int end = static_cast<long long>(num_states) * (chunk + 1) / num_threads;
+            for (int i = begin; i < end; ++i) {
+                registry.insert_id_or_pop_state(&buffers[i * num_bins]);
+            }
+        };
+    auto start = chrono::steady_clock::now();
+    utils::run_in_parallel(num_threads, [&](int thread_id) {
+                               insert_chunk(thread_id);
+                               insert_chunk((thread_id + 1) % num_threads);
+                           });
+    double seconds = get_elapsed_seconds(start);
+    log << "ConcurrentStateRegistry with " << num_threads << " threads: "
+        << 2 * num_states << " insertions, " << registry.size()
+        << " registered states, " << seconds << "s, "
+        << 2 * num_states / seconds << " insertions/s" << endl;
+    check(static_cast<int>(registry.size()) == num_states,
+          "Concurrent state registry lost or duplicated states.");
+}
+
+void ConcurrentRegistryBenchmark::run_benchmark() {
+    collect_states(max_states);
+    vector<PackedStateBin> buffers = get_state_buffers();
+    run_sequential_baseline(buffers);
+    for (int num_threads : thread_counts) {
+        run_concurrent(buffers, num_threads);
+    }
+}
+
+class ConcurrentRegistryBenchmarkFeature
+    : public plugins::TypedFeature<SearchAlgorithm, ConcurrentRegistryBenchmark> {
+public:
+    ConcurrentRegistryBenchmarkFeature() : TypedFeature("concurrent_registry_benchmark") {
+        document_title("Concurrent state registry benchmark");
+        document_synopsis(
+            "Collects reachable states with a breadth-first search and "
+            "measures how many insertions per second StateRegistry and "
+            "ConcurrentStateRegistry handle with the given numbers of "
+            "threads. Half of the insertions are duplicates.");
+
+        add_list_option<int>(
+            "threads",
+            "numbers of threads to benchmark",
+            "[1, 2, 4, 8, 16, 32]");
+        add_option<int>(
+            "max_states",
+            "maximum number of states to collect",
+            "1000000",
+            plugins::Bounds("1", "infinity"));
+        benchmark::add_benchmark_options_to_feature(*this);
+    }
+};
+
+static plugins::FeaturePlugin<ConcurrentRegistryBenchmarkFeature> _plugin;
+}
@@ -0,0 +1,34 @@
+#ifndef SEARCH_ALGORITHMS_CONCURRENT_REGISTRY_BENCHMARK_H
+#define SEARCH_ALGORITHMS_CONCURRENT_REGISTRY_BENCHMARK_H
+
+#include "benchmark.h"
+
+#include <vector>
+
+namespace concurrent_registry_benchmark {
+/*
+  Measure how fast StateRegistry and ConcurrentStateRegistry register states.
+
+  We first collect up to max_states reachable states with a breadth-first
+  search. Then, for each given number of threads, we insert all collected
+  states into a fresh ConcurrentStateRegistry. Each thread inserts its own
+  chunk of states and the chunk of the next thread, so half of all insertions
+  hit a duplicate that another thread may be inserting at the same time.
+*/
+class ConcurrentRegistryBenchmark : public benchmark::Benchmark {
+    const std::vector<int> thread_counts;
+    const int max_states;
+
+    std::vector<PackedStateBin> get_state_buffers() const;
+    void run_sequential_baseline(const std::vector<PackedStateBin> &buffers);
+    void run_concurrent(const std::vector<PackedStateBin> &buffers, int num_threads);
+
+protected:
+    virtual void run_benchmark() override;
+
+public:
+    explicit ConcurrentRegistryBenchmark(const plugins::Options &opts);
+};
+}
+
+#endif
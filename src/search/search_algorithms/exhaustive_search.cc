@@ -118,6 +118,7 @@ public:
         opts.set<OperatorCost>("cost_type", ONE);
         opts.set<int>("bound", numeric_limits<int>::max());
         opts.set<double>("max_time", numeric_limits<double>::infinity());
+        opts.set<bool>("state_fingerprints", false);
         opts.set<utils::Verbosity>("verbosity", utils::Verbosity::NORMAL);
         return make_shared<ExhaustiveSearch>(opts);
     }
@@ -0,0 +1,375 @@
+#include "external_breadth_first_search.h"
+
+#include "../plugins/plugin.h"
+#include "../task_utils/successor_generator.h"
+#include "../task_utils/task_properties.h"
+#include "../utils/collections.h"
+#include "../utils/logging.h"
+#include "../utils/system.h"
+
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <queue>
+
+using namespace std;
+
+namespace external_breadth_first_search {
+static bool is_less(const PackedStateBin *lhs, const PackedStateBin *rhs, int num_bins) {
+    return lexicographical_compare(lhs, lhs + num_bins, rhs, rhs + num_bins);
+}
+
+static bool is_equal(const PackedStateBin *lhs, const PackedStateBin *rhs, int num_bins) {
+    return equal(lhs, lhs + num_bins, rhs);
+}
+
+static void exit_with_io_error(const string &path) {
+    cerr << "Could not access state file " << path << endl;
+    utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+}
+
+class StateFileWriter {
+    const string path;
+    const int num_bins;
+    ofstream file;
+
+public:
+    StateFileWriter(const string &path, int num_bins)
+        : path(path),
+          num_bins(num_bins),
+          file(path, ios::binary) {
+        if (!file) {
+            exit_with_io_error(path);
+        }
+    }
+
+    ~StateFileWriter() {
+        file.close();
+        if (!file) {
+            exit_with_io_error(path);
+        }
+    }
+
+    void write(const PackedStateBin *buffer) {
+        file.write(reinterpret_cast<const char *>(buffer),
+                   num_bins * sizeof(PackedStateBin));
+    }
+};
+
+class StateFileReader {
+    const int num_bins;
+    ifstream file;
+    vector<PackedStateBin> state;
+
+public:
+    StateFileReader(const string &path, int num_bins)
+        : num_bins(num_bins),
+          file(path, ios::binary),
+          state(num_bins) {
+        if (!file) {
+            exit_with_io_error(path);
+        }
+    }
+
+    // Read the next state and return false if there is none.
+    bool next() {
+        file.read(reinterpret_cast<char *>(state.data()),
+                  num_bins * sizeof(PackedStateBin));
+        return file.gcount() == static_cast<streamsize>(num_bins * sizeof(PackedStateBin));
+    }
+
+    // The data is only valid until the next call to next().
+    const PackedStateBin *get() const {
+        return state.data();
+    }
+};
+
+static string create_search_directory(const string &parent_directory) {
+    filesystem::path path = filesystem::path(parent_directory) /
+        ("external-brfs-" + to_string(utils::get_process_id()));
+    error_code error;
+    filesystem::remove_all(path, error);
+    if (!filesystem::create_directories(path, error)) {
+        cerr << "Could not create directory " << path.string() << ": "
+             << error.message() << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+    }
+    return path.string();
+}
+
+static int64_t compute_buffer_size(int memory_in_mb, int num_bins) {
+    int64_t bytes = static_cast<int64_t>(memory_in_mb) * 1024 * 1024;
+    return max<int64_t>(1, bytes / (num_bins * sizeof(PackedStateBin)));
+}
+
+ExternalBreadthFirstSearch::ExternalBreadthFirstSearch(const plugins::Options &opts)
+    : SearchAlgorithm(opts),
+      num_bins(state_registry.get_state_packer().get_num_bins()),
+      buffer_size(compute_buffer_size(opts.get<int>("buffer_memory"), num_bins)),
+      directory(create_search_directory(opts.get<string>("directory"))),
+      next_file_id(0),
+      num_closed_states(0) {
+    assert(cost_type == ONE);
+}
+
+ExternalBreadthFirstSearch::~ExternalBreadthFirstSearch() {
+    remove_files();
+}
+
+void ExternalBreadthFirstSearch::remove_files() const {
+    error_code error;
+    filesystem::remove_all(directory, error);
+}
+
+string ExternalBreadthFirstSearch::get_new_file_name() {
+    return (filesystem::path(directory) / (to_string(next_file_id++) + ".states")).string();
+}
+
+vector<PackedStateBin> ExternalBreadthFirstSearch::pack(const State &state) const {
+    const int_packer::IntPacker &state_packer = state_registry.get_state_packer();
+    // Avoid garbage values in half-full bins.
+    vector<PackedStateBin> buffer(num_bins, 0);
+    state.unpack();
+    const vector<int> &values = state.get_unpacked_values();
+    for (size_t var = 0; var < values.size(); ++var) {
+        state_packer.set(buffer.data(), var, values[var]);
+    }
+    return buffer;
+}
+
+State ExternalBreadthFirstSearch::unpack(const PackedStateBin *buffer) const {
+    const int_packer::IntPacker &state_packer = state_registry.get_state_packer();
+    int num_variables = task_proxy.get_variables().size();
+    vector<int> values(num_variables);
+    for (int var = 0; var < num_variables; ++var) {
+        values[var] = state_packer.get(buffer, var);
+    }
+    return task_proxy.create_state(move(values));
+}
+
+void ExternalBreadthFirstSearch::initialize() {
+    log << "Conducting external-memory breadth-first search in " << directory
+        << " with a buffer for " << buffer_size << " states" << endl;
+    vector<PackedStateBin> initial_state = pack(task_proxy.get_initial_state());
+    statistics.inc_generated();
+    string layer_file = get_new_file_name();
+    closed_file = get_new_file_name();
+    StateFileWriter(layer_file, num_bins).write(initial_state.data());
+    StateFileWriter(closed_file, num_bins).write(initial_state.data());
+    layer_files.push_back(layer_file);
+    num_closed_states = 1;
+}
+
+string ExternalBreadthFirstSearch::write_run(vector<PackedStateBin> &buffer) {
+    size_t num_states = buffer.size() / num_bins;
+    vector<size_t> order(num_states);
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+             return is_less(&buffer[lhs * num_bins], &buffer[rhs * num_bins], num_bins);
+         });
+    string run_file = get_new_file_name();
+    StateFileWriter writer(run_file, num_bins);
+    const PackedStateBin *last = nullptr;
+    for (size_t index : order) {
+        const PackedStateBin *state = &buffer[index * num_bins];
+        if (!last || !is_equal(last, state, num_bins)) {
+            writer.write(state);
+            last = state;
+        }
+    }
+    buffer.clear();
+    return run_file;
+}
+
+int64_t ExternalBreadthFirstSearch::merge_runs_with_closed_file(
+    const vector<string> &run_files, const string &layer_file,
+    const string &new_closed_file) const {
+    vector<unique_ptr<StateFileReader>> readers;
+    for (const string &run_file : run_files) {
+        readers.push_back(utils::make_unique_ptr<StateFileReader>(run_file, num_bins));
+    }
+    // Min-heap of the run indices, ordered by their current states.
+    auto compare = [&](int lhs, int rhs) {
+            return is_less(readers[rhs]->get(), readers[lhs]->get(), num_bins);
+        };
+    priority_queue<int, vector<int>, decltype(compare)> queue(compare);
+    for (size_t i = 0; i < readers.size(); ++i) {
+        if (readers[i]->next()) {
+            queue.push(i);
+        }
+    }
+
+    StateFileReader closed_reader(closed_file, num_bins);
+    bool closed_reader_has_state = closed_reader.next();
+    StateFileWriter layer_writer(layer_file, num_bins);
+    StateFileWriter closed_writer(new_closed_file, num_bins);
+    vector<PackedStateBin> last_state;
+    int64_t num_new_states = 0;
+    while (!queue.empty()) {
+        int run = queue.top();
+        queue.pop();
+        const PackedStateBin *state = readers[run]->get();
+        if (last_state.empty() || !is_equal(last_state.data(), state, num_bins)) {
+            while (closed_reader_has_state &&
+                   is_less(closed_reader.get(), state, num_bins)) {
+                closed_writer.write(closed_reader.get());
+                closed_reader_has_state = closed_reader.next();
+            }
+            if (!closed_reader_has_state ||
+                !is_equal(closed_reader.get(), state, num_bins)) {
+                layer_writer.write(state);
+                closed_writer.write(state);
+                ++num_new_states;
+            }
+            last_state.assign(state, state + num_bins);
+        }
+        if (readers[run]->next()) {
+            queue.push(run);
+        }
+    }
+    while (closed_reader_has_state) {
+        closed_writer.write(closed_reader.get());
+        closed_reader_has_state = closed_reader.next();
+    }
+    return num_new_states;
+}
+
+vector<OperatorID> ExternalBreadthFirstSearch::trace_path(
+    const vector<PackedStateBin> &goal) const {
+    vector<OperatorID> path;
+    vector<PackedStateBin> current_state = goal;
+    vector<OperatorID> applicable_op_ids;
+    OperatorsProxy operators = task_proxy.get_operators();
+    // The goal lies in the last layer. Find a parent in each earlier layer.
+    for (int layer = layer_files.size() - 2; layer >= 0; --layer) {
+        StateFileReader reader(layer_files[layer], num_bins);
+        bool found_parent = false;
+        while (!found_parent && reader.next()) {
+            State state = unpack(reader.get());
+            applicable_op_ids.clear();
+            successor_generator.generate_applicable_ops(state, applicable_op_ids);
+            for (OperatorID op_id : applicable_op_ids) {
+                State succ_state = state.get_unregistered_successor(operators[op_id]);
+                if (pack(succ_state) == current_state) {
+                    path.push_back(op_id);
+                    current_state.assign(reader.get(), reader.get() + num_bins);
+                    found_parent = true;
+                    break;
+                }
+            }
+        }
+        assert(found_parent);
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+SearchStatus ExternalBreadthFirstSearch::step() {
+    vector<PackedStateBin> buffer;
+    vector<string> run_files;
+    vector<OperatorID> applicable_op_ids;
+    OperatorsProxy operators = task_proxy.get_operators();
+    StateFileReader reader(layer_files.back(), num_bins);
+    while (reader.next()) {
+        State state = unpack(reader.get());
+        statistics.inc_expanded();
+
+        if (task_properties::is_goal_state(task_proxy, state)) {
+            log << "Solution found!" << endl;
+            set_plan(trace_path(vector<PackedStateBin>(
+                                    reader.get(), reader.get() + num_bins)));
+            remove_files();
+            return SOLVED;
+        }
+
+        applicable_op_ids.clear();
+        successor_generator.generate_applicable_ops(state, applicable_op_ids);
+        for (OperatorID op_id : applicable_op_ids) {
+            State succ_state = state.get_unregistered_successor(operators[op_id]);
+            statistics.inc_generated();
+            vector<PackedStateBin> succ_buffer = pack(succ_state);
+            buffer.insert(buffer.end(), succ_buffer.begin(), succ_buffer.end());
+            if (static_cast<int64_t>(buffer.size() / num_bins) >= buffer_size) {
+                run_files.push_back(write_run(buffer));
+            }
+        }
+    }
+    if (!buffer.empty()) {
+        run_files.push_back(write_run(buffer));
+    }
+    utils::release_vector_memory(buffer);
+
+    string layer_file = get_new_file_name();
+    string new_closed_file = get_new_file_name();
+    int64_t num_new_states = merge_runs_with_closed_file(
+        run_files, layer_file, new_closed_file);
+    error_code error;
+    for (const string &run_file : run_files) {
+        filesystem::remove(run_file, error);
+    }
+    filesystem::remove(closed_file, error);
+    closed_file = new_closed_file;
+    num_closed_states += num_new_states;
+
+    log << "Layer " << layer_files.size() << ": " << num_new_states
+        << " new states from " << run_files.size() << " runs, "
+        << num_closed_states << " states in total" << endl;
+
+    if (num_new_states == 0) {
+        remove_files();
+        log << "Completely explored state space -- no solution!" << endl;
+        return UNSOLVABLE;
+    }
+    layer_files.push_back(layer_file);
+    return IN_PROGRESS;
+}
+
+void ExternalBreadthFirstSearch::print_statistics() const {
+    statistics.print_detailed_statistics();
+    log << "Number of layers: " << layer_files.size() << endl;
+    log << "Number of reached states: " << num_closed_states << endl;
+}
+
+class ExternalBreadthFirstSearchFeature
+    : public plugins::TypedFeature<SearchAlgorithm, ExternalBreadthFirstSearch> {
+public:
+    ExternalBreadthFirstSearchFeature() : TypedFeature("external_brfs") {
+        document_title("External-memory breadth-first search");
+        document_synopsis(
+            "Breadth-first search that stores all states on disk and uses "
+            "delayed duplicate detection per layer (Korf, AAAI 2004). "
+            "Only the buffer for sorting successors lives in RAM, so the "
+            "search can handle state spaces that are bounded by disk space "
+            "rather than memory. Returns a shortest plan.");
+        add_option<string>(
+            "directory",
+            "directory for the state files. The search creates and "
+            "afterwards removes a subdirectory there. Use a local disk.",
+            "\".\"");
+        add_option<int>(
+            "buffer_memory",
+            "memory in MiB for buffering and sorting successor states",
+            "1024",
+            plugins::Bounds("1", "infinity"));
+        utils::add_log_options_to_feature(*this);
+
+        document_language_support("action costs", "ignored by design");
+        document_language_support("conditional effects", "supported");
+        document_language_support("axioms", "supported");
+    }
+
+    virtual shared_ptr<ExternalBreadthFirstSearch> create_component(
+        const plugins::Options &options, const utils::Context &) const override {
+        plugins::Options opts = options;
+        opts.set<OperatorCost>("cost_type", ONE);
+        opts.set<int>("bound", numeric_limits<int>::max());
+        opts.set<double>("max_time", numeric_limits<double>::infinity());
+        opts.set<bool>("state_fingerprints", false);
+        return make_shared<ExternalBreadthFirstSearch>(opts);
+    }
+};
+
+static plugins::FeaturePlugin<ExternalBreadthFirstSearchFeature> _plugin;
+}
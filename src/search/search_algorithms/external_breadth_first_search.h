@@ -0,0 +1,66 @@
+#ifndef SEARCH_ALGORITHMS_EXTERNAL_BREADTH_FIRST_SEARCH_H
+#define SEARCH_ALGORITHMS_EXTERNAL_BREADTH_FIRST_SEARCH_H
+
+#include "../search_algorithm.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace external_breadth_first_search {
+/*
+  Breadth-first search that stores states on disk and detects duplicates
+  with delayed duplicate detection (Korf, AAAI 2004).
+
+  Each BFS layer is a file of packed states, sorted lexicographically and
+  without duplicates. We also keep a sorted file of all states seen so far
+  (the closed file). While expanding a layer, we collect the successors in a
+  memory buffer. Whenever it is full, we sort it, remove duplicates and write
+  it to a run file. After the layer, we merge all runs with the closed file.
+  Successors that don't occur in the closed file form the next layer, and
+  all of them are added to a new closed file.
+
+  RAM usage is bounded by the size of the buffer. Disk usage is about twice
+  the size of all reached states, because we keep the layer files for
+  reconstructing the plan. For this, we scan the previous layer for a state
+  that has the current plan state as a successor, so we don't need to store
+  parent pointers.
+
+  All files live in a fresh subdirectory of the given directory, which is
+  removed when the search terminates.
+*/
+class ExternalBreadthFirstSearch : public SearchAlgorithm {
+    const int num_bins;
+    const int64_t buffer_size;
+    const std::string directory;
+
+    std::vector<std::string> layer_files;
+    std::string closed_file;
+    int next_file_id;
+    int64_t num_closed_states;
+
+    std::string get_new_file_name();
+    // The planner exits without destroying the search, so we clean up early.
+    void remove_files() const;
+    std::vector<PackedStateBin> pack(const State &state) const;
+    State unpack(const PackedStateBin *buffer) const;
+
+    std::string write_run(std::vector<PackedStateBin> &buffer);
+    int64_t merge_runs_with_closed_file(
+        const std::vector<std::string> &run_files, const std::string &layer_file,
+        const std::string &new_closed_file) const;
+    std::vector<OperatorID> trace_path(const std::vector<PackedStateBin> &goal) const;
+
+protected:
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+
+public:
+    explicit ExternalBreadthFirstSearch(const plugins::Options &opts);
+    virtual ~ExternalBreadthFirstSearch() override;
+
+    virtual void print_statistics() const override;
+};
+}
+
+#endif
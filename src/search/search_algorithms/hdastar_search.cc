@@ -0,0 +1,497 @@
+#include "hdastar_search.h"
+
+#include "../evaluation_context.h"
+#include "../evaluator.h"
+#include "../per_state_information.h"
+
+#include "../algorithms/mpsc_queue.h"
+#include "../plugins/plugin.h"
+#include "../task_utils/successor_generator.h"
+#include "../task_utils/task_properties.h"
+#include "../utils/countdown_timer.h"
+#include "../utils/hash.h"
+#include "../utils/logging.h"
+#include "../utils/parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <queue>
+#include <set>
+#include <thread>
+
+using namespace std;
+
+namespace hdastar_search {
+/*
+  A generated state sent to its owner, together with the information needed
+  for reconstructing the path to it.
+*/
+struct Message {
+    vector<PackedStateBin> buffer;
+    int g;
+    int parent_worker_id;
+    StateID parent_state_id;
+    OperatorID op_id;
+
+    Message(vector<PackedStateBin> &&buffer, int g, int parent_worker_id,
+            StateID parent_state_id, OperatorID op_id)
+        : buffer(move(buffer)),
+          g(g),
+          parent_worker_id(parent_worker_id),
+          parent_state_id(parent_state_id),
+          op_id(op_id) {
+    }
+};
+
+struct NodeInfo {
+    // g = -1 means that the state has not been reached yet.
+    int g;
+    bool closed;
+    // The parent state lives in the registry of the parent worker.
+    int parent_worker_id;
+    StateID parent_state_id;
+    OperatorID creating_operator;
+
+    NodeInfo()
+        : g(-1),
+          closed(false),
+          parent_worker_id(-1),
+          parent_state_id(StateID::no_state),
+          creating_operator(OperatorID::no_operator) {
+    }
+};
+
+struct OpenListEntry {
+    int f;
+    int h;
+    StateID state_id;
+
+    OpenListEntry(int f, int h, StateID state_id)
+        : f(f), h(h), state_id(state_id) {
+    }
+
+    // Order entries by f and break ties by h (std::priority_queue is a max-heap).
+    bool operator<(const OpenListEntry &other) const {
+        if (f != other.f) {
+            return f > other.f;
+        }
+        return h > other.h;
+    }
+};
+
+static int get_owner(const vector<PackedStateBin> &buffer, int num_threads) {
+    utils::HashState hash_state;
+    for (PackedStateBin bin : buffer) {
+        hash_state.feed(bin);
+    }
+    /* Use the upper bits of the hash value since the state registries use
+       the lower bits and all states of a registry share the same owner. */
+    return static_cast<int>((hash_state.get_hash64() >> 32) % num_threads);
+}
+
+class HDAStarWorker {
+    HDAStarSearch &search;
+    const int id;
+    StateRegistry registry;
+    const shared_ptr<Evaluator> evaluator;
+    PerStateInformation<NodeInfo> nodes;
+    priority_queue<OpenListEntry> open_list;
+    mpsc_queue::MPSCQueue<vector<Message>> inbox;
+    // Messages generated during the current expansion, grouped by owner.
+    vector<vector<Message>> outbox;
+
+    unique_ptr<utils::CountdownTimer> timer;
+
+    int num_expanded;
+    int num_evaluated;
+    int num_generated;
+    int num_reopened;
+    int num_dead_ends;
+    int num_sent_messages;
+
+    bool check_timeout();
+    void insert_state(
+        const PackedStateBin *buffer, int g, int parent_worker_id,
+        StateID parent_state_id, OperatorID op_id);
+    void process_messages();
+    bool has_promising_node();
+    void expand_best_node();
+    void flush_outbox();
+    void wait_for_messages();
+
+public:
+    HDAStarWorker(
+        HDAStarSearch &search, int id, const shared_ptr<Evaluator> &evaluator);
+
+    void receive(vector<Message> &&messages) {
+        inbox.push(move(messages));
+    }
+
+    void run();
+
+    const NodeInfo &get_node_info(StateID state_id) const {
+        return nodes[registry.lookup_state(state_id)];
+    }
+
+    void add_statistics(SearchStatistics &statistics) const;
+    int get_num_expanded() const {return num_expanded;}
+    int get_num_registered_states() const {return registry.size();}
+    int get_num_sent_messages() const {return num_sent_messages;}
+};
+
+HDAStarWorker::HDAStarWorker(
+    HDAStarSearch &search, int id, const shared_ptr<Evaluator> &evaluator)
+    : search(search),
+      id(id),
+      registry(search.task_proxy),
+      evaluator(evaluator),
+      outbox(search.num_threads),
+      num_expanded(0),
+      num_evaluated(0),
+      num_generated(0),
+      num_reopened(0),
+      num_dead_ends(0),
+      num_sent_messages(0) {
+}
+
+bool HDAStarWorker::check_timeout() {
+    // Only the first worker checks the time limit.
+    if (timer && timer->is_expired()) {
+        search.timed_out = true;
+        search.stop_search = true;
+    }
+    return search.stop_search;
+}
+
+void HDAStarWorker::insert_state(
+    const PackedStateBin *buffer, int g, int parent_worker_id,
+    StateID parent_state_id, OperatorID op_id) {
+    State state = registry.register_state(buffer);
+    NodeInfo &info = nodes[state];
+    if (info.g != -1 && info.g <= g) {
+        return;
+    }
+    bool is_new = (info.g == -1);
+    if (!is_new && info.closed) {
+        ++num_reopened;
+    }
+    info.g = g;
+    info.closed = false;
+    info.parent_worker_id = parent_worker_id;
+    info.parent_state_id = parent_state_id;
+    info.creating_operator = op_id;
+
+    EvaluationContext eval_context(state, g, false, nullptr);
+    int h = eval_context.get_evaluator_value_or_infinity(evaluator.get());
+    if (is_new) {
+        ++num_evaluated;
+    }
+    if (h == EvaluationResult::INFTY) {
+        if (is_new) {
+            ++num_dead_ends;
+        }
+        nodes[state].closed = true;
+        return;
+    }
+    open_list.emplace(g + h, h, state.get_id());
+}
+
+void HDAStarWorker::process_messages() {
+    if (inbox.empty()) {
+        return;
+    }
+    vector<vector<Message>> batches = inbox.pop_all();
+    for (const vector<Message> &batch : batches) {
+        for (const Message &message : batch) {
+            insert_state(message.buffer.data(), message.g, message.parent_worker_id,
+                         message.parent_state_id, message.op_id);
+        }
+    }
+    // Only count the messages as delivered once they are in the open list.
+    search.num_active_threads_and_messages -= static_cast<int>(batches.size());
+}
+
+bool HDAStarWorker::has_promising_node() {
+    while (!open_list.empty()) {
+        const OpenListEntry &entry = open_list.top();
+        if (entry.f >= search.incumbent_cost) {
+            // The incumbent cost never increases, so we can drop all entries.
+            open_list = priority_queue<OpenListEntry>();
+            return false;
+        }
+        const NodeInfo &info = get_node_info(entry.state_id);
+        if (info.closed || entry.f - entry.h != info.g) {
+            // The entry is outdated.
+            open_list.pop();
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+void HDAStarWorker::expand_best_node() {
+    StateID state_id = open_list.top().state_id;
+    open_list.pop();
+    State state = registry.lookup_state(state_id);
+    NodeInfo &info = nodes[state];
+    assert(!info.closed);
+    info.closed = true;
+    int g = info.g;
+    ++num_expanded;
+
+    if (task_properties::is_goal_state(search.task_proxy, state)) {
+        search.report_goal(id, state_id, g);
+        return;
+    }
+
+    vector<OperatorID> applicable_ops;
+    search.successor_generator.generate_applicable_ops(state, applicable_ops);
+    state.unpack();
+    const int_packer::IntPacker &state_packer = registry.get_state_packer();
+    const PackedStateBin *buffer = state.get_buffer();
+    int num_bins = state_packer.get_num_bins();
+    OperatorsProxy operators = search.task_proxy.get_operators();
+    for (OperatorID op_id : applicable_ops) {
+        OperatorProxy op = operators[op_id];
+        int succ_g = g + search.get_adjusted_cost(op);
+        ++num_generated;
+        if (succ_g >= search.incumbent_cost) {
+            continue;
+        }
+        vector<PackedStateBin> succ_buffer(buffer, buffer + num_bins);
+        for (EffectProxy effect : op.get_effects()) {
+            if (does_fire(effect, state)) {
+                FactPair fact = effect.get_fact().get_pair();
+                state_packer.set(succ_buffer.data(), fact.var, fact.value);
+            }
+        }
+        int owner = get_owner(succ_buffer, search.num_threads);
+        if (owner == id) {
+            insert_state(succ_buffer.data(), succ_g, id, state_id, op_id);
+        } else {
+            outbox[owner].emplace_back(move(succ_buffer), succ_g, id, state_id, op_id);
+        }
+    }
+}
+
+void HDAStarWorker::flush_outbox() {
+    for (int owner = 0; owner < search.num_threads; ++owner) {
+        vector<Message> &messages = outbox[owner];
+        if (!messages.empty()) {
+            num_sent_messages += messages.size();
+            // Count the batch as in transit before the owner can see it.
+            ++search.num_active_threads_and_messages;
+            search.workers[owner]->receive(move(messages));
+            messages.clear();
+        }
+    }
+}
+
+void HDAStarWorker::wait_for_messages() {
+    --search.num_active_threads_and_messages;
+    while (inbox.empty()) {
+        if (check_timeout()) {
+            return;
+        }
+        if (search.num_active_threads_and_messages == 0) {
+            // All threads are idle and no message is in transit.
+            search.stop_search = true;
+            return;
+        }
+        this_thread::yield();
+    }
+    ++search.num_active_threads_and_messages;
+}
+
+void HDAStarWorker::run() {
+    if (id == 0) {
+        timer = utils::make_unique_ptr<utils::CountdownTimer>(search.max_time);
+    }
+    while (!check_timeout()) {
+        process_messages();
+        if (has_promising_node()) {
+            expand_best_node();
+            flush_outbox();
+        } else {
+            wait_for_messages();
+        }
+    }
+}
+
+void HDAStarWorker::add_statistics(SearchStatistics &statistics) const {
+    statistics.inc_expanded(num_expanded);
+    statistics.inc_evaluated_states(num_evaluated);
+    statistics.inc_evaluations(num_evaluated);
+    statistics.inc_generated(num_generated);
+    statistics.inc_reopened(num_reopened);
+    statistics.inc_dead_ends(num_dead_ends);
+}
+
+
+HDAStarSearch::HDAStarSearch(const plugins::Options &opts)
+    : SearchAlgorithm(opts),
+      num_threads(opts.get<int>("threads")),
+      eval_config(opts.get<parser::LazyValue>("eval")),
+      incumbent_cost(bound),
+      num_active_threads_and_messages(0),
+      stop_search(false),
+      timed_out(false),
+      goal_worker_id(-1),
+      goal_state_id(StateID::no_state) {
+    task_properties::verify_no_axioms(task_proxy);
+
+    set<Evaluator *> evaluators;
+    for (int i = 0; i < num_threads; ++i) {
+        shared_ptr<Evaluator> evaluator;
+        try {
+            evaluator = eval_config.construct<shared_ptr<Evaluator>>();
+        } catch (const utils::ContextError &e) {
+            cerr << "Delayed construction of LazyValue failed" << endl;
+            cerr << e.get_message() << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+        }
+        if (!evaluators.insert(evaluator.get()).second) {
+            cerr << "hdastar() needs one evaluator per thread. Don't use "
+                 << "predefined evaluators for its eval option." << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+        }
+        set<Evaluator *> path_dependent_evaluators;
+        evaluator->get_path_dependent_evaluators(path_dependent_evaluators);
+        if (!path_dependent_evaluators.empty()) {
+            cerr << "hdastar() doesn't support path-dependent evaluators." << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_UNSUPPORTED);
+        }
+        workers.push_back(utils::make_unique_ptr<HDAStarWorker>(*this, i, evaluator));
+    }
+}
+
+HDAStarSearch::~HDAStarSearch() {
+}
+
+void HDAStarSearch::initialize() {
+    log << "Conducting hash-distributed A* search with " << num_threads
+        << " threads, (real) bound = " << bound << endl;
+    const State &initial_state = state_registry.get_initial_state();
+    const PackedStateBin *buffer = initial_state.get_buffer();
+    vector<PackedStateBin> initial_buffer(
+        buffer, buffer + state_registry.get_state_packer().get_num_bins());
+    int owner = get_owner(initial_buffer, num_threads);
+    vector<Message> messages;
+    messages.emplace_back(
+        move(initial_buffer), 0, -1, StateID::no_state, OperatorID::no_operator);
+    // All threads start as active threads.
+    num_active_threads_and_messages = num_threads + 1;
+    workers[owner]->receive(move(messages));
+}
+
+void HDAStarSearch::report_goal(int worker_id, StateID state_id, int g) {
+    lock_guard<mutex> lock(solution_mutex);
+    if (g < incumbent_cost) {
+        incumbent_cost = g;
+        goal_worker_id = worker_id;
+        goal_state_id = state_id;
+        log << "Found solution with cost " << g << " in thread " << worker_id
+            << endl;
+    }
+}
+
+vector<OperatorID> HDAStarSearch::trace_path() const {
+    vector<OperatorID> path;
+    int worker_id = goal_worker_id;
+    StateID state_id = goal_state_id;
+    while (true) {
+        const NodeInfo &info = workers[worker_id]->get_node_info(state_id);
+        if (info.creating_operator == OperatorID::no_operator) {
+            break;
+        }
+        path.push_back(info.creating_operator);
+        worker_id = info.parent_worker_id;
+        state_id = info.parent_state_id;
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+SearchStatus HDAStarSearch::step() {
+    utils::run_in_parallel(num_threads, [this](int thread_id) {
+                               workers[thread_id]->run();
+                           });
+
+    for (const auto &worker : workers) {
+        worker->add_statistics(statistics);
+    }
+
+    if (timed_out) {
+        log << "Time limit reached. Abort search." << endl;
+        return TIMEOUT;
+    }
+    if (goal_worker_id == -1) {
+        log << "Completely explored state space -- no solution!" << endl;
+        return FAILED;
+    }
+    log << "Solution found!" << endl;
+    set_plan(trace_path());
+    return SOLVED;
+}
+
+void HDAStarSearch::print_statistics() const {
+    statistics.print_detailed_statistics();
+    vector<int> expanded_per_thread;
+    vector<int> registered_per_thread;
+    int num_sent_messages = 0;
+    for (const auto &worker : workers) {
+        expanded_per_thread.push_back(worker->get_num_expanded());
+        registered_per_thread.push_back(worker->get_num_registered_states());
+        num_sent_messages += worker->get_num_sent_messages();
+    }
+    log << "Expanded states per thread: " << expanded_per_thread << endl;
+    log << "Registered states per thread: " << registered_per_thread << endl;
+    log << "States sent to other threads: " << num_sent_messages << endl;
+}
+
+class HDAStarSearchFeature
+    : public plugins::TypedFeature<SearchAlgorithm, HDAStarSearch> {
+public:
+    HDAStarSearchFeature() : TypedFeature("hdastar") {
+        document_title("Hash-distributed A* search");
+        document_synopsis(
+            "Parallel A* search that distributes states among threads by their "
+            "hash value (Kishimoto, Fukunaga and Botea, ICAPS 2009). Each "
+            "thread uses its own state registry, open list and evaluator. "
+            "Closed nodes are re-opened. With an admissible evaluator, the "
+            "search returns an optimal plan.");
+
+        add_option<shared_ptr<Evaluator>>(
+            "eval",
+            "evaluator for h-value. It is constructed once for each thread.",
+            "",
+            plugins::Bounds::unlimited(),
+            true);
+        add_option<int>(
+            "threads",
+            "number of threads",
+            "1",
+            plugins::Bounds("1", "infinity"));
+        SearchAlgorithm::add_options_to_feature(*this);
+
+        document_language_support("action costs", "supported");
+        document_language_support("conditional effects", "supported");
+        document_language_support("axioms", "not supported");
+
+        document_note(
+            "Evaluators",
+            "Since each thread needs its own evaluator, the eval option must "
+            "not refer to a predefined evaluator. Path-dependent evaluators are "
+            "not supported. The evaluators of different threads must not share "
+            "mutable state, which holds for all heuristics that only read "
+            "data computed during their construction.");
+        document_note(
+            "Time limit",
+            "max_time limits the CPU time of the whole process, so with "
+            "multiple threads it expires faster than in wall-clock time.");
+    }
+};
+
+static plugins::FeaturePlugin<HDAStarSearchFeature> _plugin;
+}
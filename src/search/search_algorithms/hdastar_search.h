@@ -0,0 +1,63 @@
+#ifndef SEARCH_ALGORITHMS_HDASTAR_SEARCH_H
+#define SEARCH_ALGORITHMS_HDASTAR_SEARCH_H
+
+#include "../search_algorithm.h"
+
+#include "../parser/decorated_abstract_syntax_tree.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hdastar_search {
+class HDAStarWorker;
+
+/*
+  Hash-distributed A* (HDA*, Kishimoto, Fukunaga and Botea, ICAPS 2009).
+
+  Each thread owns the states whose hash value modulo the number of threads
+  equals its ID. A thread keeps its own state registry, open list and
+  heuristic object and only expands states it owns. Successors owned by other
+  threads are sent to their owner through a lock-free message queue.
+
+  A goal state found by any thread becomes the incumbent solution and all
+  threads prune states whose f value is not lower than the incumbent cost.
+  The search ends when all threads are idle (no state with f < incumbent in
+  their open list) and no message is in transit. We detect this with a single
+  counter that tracks the number of active threads plus the number of
+  messages in transit.
+*/
+class HDAStarSearch : public SearchAlgorithm {
+    friend class HDAStarWorker;
+
+    const int num_threads;
+    const parser::LazyValue eval_config;
+
+    std::vector<std::unique_ptr<HDAStarWorker>> workers;
+
+    // Shared state for all workers.
+    std::atomic<int> incumbent_cost;
+    std::atomic<int> num_active_threads_and_messages;
+    std::atomic<bool> stop_search;
+    std::atomic<bool> timed_out;
+    std::mutex solution_mutex;
+    int goal_worker_id;
+    StateID goal_state_id;
+
+    void report_goal(int worker_id, StateID state_id, int g);
+    std::vector<OperatorID> trace_path() const;
+
+protected:
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+
+public:
+    explicit HDAStarSearch(const plugins::Options &opts);
+    virtual ~HDAStarSearch() override;
+
+    virtual void print_statistics() const override;
+};
+}
+
+#endif
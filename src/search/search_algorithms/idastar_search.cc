@@ -7,131 +7,226 @@
 #include "../task_utils/successor_generator.h"
 #include "../task_utils/task_properties.h"
 
+#include "../utils/hash.h"
 #include "../utils/logging.h"
 #include "../utils/memory.h"
+#include "../utils/parallel.h"
 #include "../utils/timer.h"
 
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
+#include <deque>
+#include <optional>
+#include <set>
 
 using namespace std;
 
 namespace idastar_search {
 static const int INF = numeric_limits<int>::max();
-static const int MEMORY_PADDING_MB = 512;
 
-FifoCache::FifoCache(int max_size)
-    : max_size(max_size) {
-    if (max_size == INF) {
-        utils::reserve_extra_memory_padding(MEMORY_PADDING_MB);
-    }
+static uint64_t pack_entry_data(int g, int iteration) {
+    assert(g >= 0 && iteration >= 1);
+    return (static_cast<uint64_t>(iteration) << 32) | static_cast<uint32_t>(g);
 }
 
-void FifoCache::add(const State &state, int g, int iteration) {
-    assert(state_to_g_and_iteration.size() == states.size());
-    if (max_size == 0) {
-        return;
+static int get_g(uint64_t data) {
+    return static_cast<int>(data & 0xffffffff);
+}
+
+static int get_iteration(uint64_t data) {
+    return static_cast<int>(data >> 32);
+}
+
+// Return true if we should rather replace an entry with data1 than data2.
+static bool is_better_victim(uint64_t data1, uint64_t data2) {
+    if (data1 == 0 || data2 == 0) {
+        return data1 == 0 && data2 != 0;
     }
-    if (max_size == INF && !utils::extra_memory_padding_is_reserved()) {
-        max_size = states.size();
+    if (get_iteration(data1) != get_iteration(data2)) {
+        return get_iteration(data1) < get_iteration(data2);
     }
-    if (!state_to_g_and_iteration.count(state)) {
-        states.push(state);
+    return get_g(data1) > get_g(data2);
+}
+
+TranspositionTable::TranspositionTable(int size_in_mb) {
+    uint64_t max_buckets =
+        (static_cast<uint64_t>(size_in_mb) << 20) / (BUCKET_SIZE * sizeof(Entry));
+    uint64_t num_buckets = 1;
+    while (2 * num_buckets <= max_buckets) {
+        num_buckets *= 2;
     }
-    state_to_g_and_iteration[state] = make_pair(g, iteration);
-    assert(state_to_g_and_iteration.size() == states.size());
-    if (static_cast<int>(state_to_g_and_iteration.size()) > max_size) {
-        State &oldest_state = states.front();
-        state_to_g_and_iteration.erase(oldest_state);
-        states.pop();
+    bucket_mask = num_buckets - 1;
+    entries = vector<Entry>(num_buckets * BUCKET_SIZE);
+}
+
+void TranspositionTable::add(uint64_t key, int g, int iteration) {
+    Entry *bucket = get_bucket(key);
+    Entry *victim = &bucket[0];
+    uint64_t victim_data = victim->data.load(memory_order_relaxed);
+    for (int i = 0; i < BUCKET_SIZE; ++i) {
+        Entry &entry = bucket[i];
+        uint64_t data = entry.data.load(memory_order_relaxed);
+        if (data != 0 &&
+            (entry.key_xor_data.load(memory_order_relaxed) ^ data) == key) {
+            victim = &entry;
+            break;
+        }
+        if (is_better_victim(data, victim_data)) {
+            victim = &entry;
+            victim_data = data;
+        }
     }
+    uint64_t data = pack_entry_data(g, iteration);
+    victim->key_xor_data.store(key ^ data, memory_order_relaxed);
+    victim->data.store(data, memory_order_relaxed);
 }
 
-CacheValue FifoCache::lookup(const State &state) const {
-    auto iter = state_to_g_and_iteration.find(state);
-    if (iter == state_to_g_and_iteration.end()) {
-        return make_pair(INF, -1);
-    } else {
-        return iter->second;
+CacheValue TranspositionTable::lookup(uint64_t key) {
+    Entry *bucket = get_bucket(key);
+    for (int i = 0; i < BUCKET_SIZE; ++i) {
+        Entry &entry = bucket[i];
+        uint64_t data = entry.data.load(memory_order_relaxed);
+        if (data != 0 &&
+            (entry.key_xor_data.load(memory_order_relaxed) ^ data) == key) {
+            return make_pair(get_g(data), get_iteration(data));
+        }
     }
+    return make_pair(INF, -1);
 }
 
-void FifoCache::clear() {
-    state_to_g_and_iteration.clear();
-    queue<State>().swap(states);
+size_t TranspositionTable::get_num_entries() const {
+    return entries.size();
 }
 
-IDAstarSearch::IDAstarSearch(const plugins::Options &opts)
-    : SearchAlgorithm(opts),
-      h_evaluator(opts.get<shared_ptr<Evaluator>>("eval")),
-      single_plan(opts.get<bool>("single_plan")),
-      iteration(0),
-      f_limit(opts.get<int>("initial_f_limit")),
-      cheapest_plan_cost(numeric_limits<int>::max()),
-      num_cache_hits(0),
-      num_expansions(0),
-      num_evaluations(0) {
-    if (h_evaluator->does_cache_estimates()) {
-        cerr << "Error: set cache_estimates=false for IDA* heuristics." << endl;
-        utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
-    }
-    int cache_size = opts.get<int>("cache_size");
-    if (cache_size > 0) {
-        cache = utils::make_unique_ptr<FifoCache>(cache_size);
+size_t TranspositionTable::count_used_entries() const {
+    size_t num_used_entries = 0;
+    for (const Entry &entry : entries) {
+        if (entry.data.load(memory_order_relaxed) != 0) {
+            ++num_used_entries;
+        }
     }
+    return num_used_entries;
 }
 
-void IDAstarSearch::initialize() {
-    cout << "Conducting IDA* search, (real) bound = " << bound << endl;
+/*
+  Subtree of an IDA* iteration that a thread searches on its own. The
+  operator sequence leads from the initial state to the root of the subtree.
+*/
+struct WorkUnit {
+    IDAstarNode node;
+    Plan operator_sequence;
+
+    WorkUnit(const IDAstarNode &node, const Plan &operator_sequence)
+        : node(node),
+          operator_sequence(operator_sequence) {
+    }
+};
+
+static void update_minimum(atomic<int> &minimum, int value) {
+    int current = minimum.load();
+    while (value < current && !minimum.compare_exchange_weak(current, value)) {
+    }
 }
 
-void IDAstarSearch::print_statistics() const {
-    cout << "Expansions: " << num_expansions << endl;
-    cout << "Evaluations: " << num_evaluations << endl;
-    cout << "IDA* cache hits: " << num_cache_hits << endl;
-    cout << "IDA* iterations: " << iteration << endl;
+class IDAstarWorker {
+    IDAstarSearch &search;
+    const int id;
+    const shared_ptr<Evaluator> h_evaluator;
+    Plan operator_sequence;
+
+    TranspositionTable *transposition_table;
+
+    /* The owner takes work units from the back, other threads steal them
+       from the front. */
+    deque<WorkUnit> work_units;
+    mutex work_units_mutex;
+
+    // If split_nodes is set, collect the nodes at split_depth as work units.
+    int split_depth;
+    vector<WorkUnit> *split_nodes;
+
+    int num_cache_hits;
+    uint64_t num_expansions;
+    uint64_t num_evaluations;
+    double busy_seconds;
+
+    optional<WorkUnit> pop_work_unit();
+    optional<WorkUnit> steal_work_unit();
+
+public:
+    IDAstarWorker(
+        IDAstarSearch &search, int id, const shared_ptr<Evaluator> &h_evaluator,
+        TranspositionTable *transposition_table);
+
+    int compute_h_value(const State &state) const;
+    int recursive_search(const IDAstarNode &node, int depth);
+    int split(const IDAstarNode &root, int depth, vector<WorkUnit> &units);
+
+    void add_work_unit(WorkUnit &&unit);
+    void run();
+
+    int get_num_cache_hits() const {return num_cache_hits;}
+    uint64_t get_num_expansions() const {return num_expansions;}
+    uint64_t get_num_evaluations() const {return num_evaluations;}
+    double get_busy_seconds() const {return busy_seconds;}
+};
+
+IDAstarWorker::IDAstarWorker(
+    IDAstarSearch &search, int id, const shared_ptr<Evaluator> &h_evaluator,
+    TranspositionTable *transposition_table)
+    : search(search),
+      id(id),
+      h_evaluator(h_evaluator),
+      transposition_table(transposition_table),
+      split_depth(-1),
+      split_nodes(nullptr),
+      num_cache_hits(0),
+      num_expansions(0),
+      num_evaluations(0),
+      busy_seconds(0) {
 }
 
-int IDAstarSearch::compute_h_value(const State &state) const {
+int IDAstarWorker::compute_h_value(const State &state) const {
     EvaluationContext eval_context(state);
     return eval_context.get_evaluator_value_or_infinity(h_evaluator.get());
 }
 
-int IDAstarSearch::recursive_search(const IDAstarNode &node) {
+int IDAstarWorker::recursive_search(const IDAstarNode &node, int depth) {
     int f = node.g + node.h;
-    if (f > f_limit) {
+    if (f > search.f_limit) {
         return f;
     }
-    if (task_properties::is_goal_state(task_proxy, node.state)) {
-        int plan_cost = calculate_plan_cost(operator_sequence, task_proxy);
-        cout << "Found solution with cost " << plan_cost << endl;
-        if (plan_cost < cheapest_plan_cost) {
-            plan_manager.save_plan(operator_sequence, task_proxy, !single_plan);
-            cheapest_plan_cost = plan_cost;
-            set_plan(operator_sequence);
-            f_limit = plan_cost - 1;
-        }
+    if (task_properties::is_goal_state(search.task_proxy, node.state)) {
+        search.report_plan(operator_sequence);
         return -1;
     }
+    if (depth == split_depth) {
+        // The thread that searches the subtree reports its next f limit.
+        split_nodes->emplace_back(node, operator_sequence);
+        return INF;
+    }
 
     ++num_expansions;
     int next_limit = INF;
     vector<OperatorID> applicable_ops;
-    successor_generator.generate_applicable_ops(node.state, applicable_ops);
-    OperatorsProxy operators = task_proxy.get_operators();
+    search.successor_generator.generate_applicable_ops(node.state, applicable_ops);
+    OperatorsProxy operators = search.task_proxy.get_operators();
     for (OperatorID op_id : applicable_ops) {
         OperatorProxy op = operators[op_id];
         State succ_state = node.state.get_unregistered_successor(op);
-        int succ_g = node.g + get_adjusted_cost(op);
-        if (cache) {
-            CacheValue pair = cache->lookup(succ_state);
+        int succ_g = node.g + search.get_adjusted_cost(op);
+        if (transposition_table) {
+            uint64_t key = utils::get_hash64(succ_state);
+            CacheValue pair = transposition_table->lookup(key);
             int old_succ_g = pair.first;
             int old_iteration = pair.second;
-            if (succ_g > old_succ_g || (succ_g == old_succ_g && iteration == old_iteration)) {
+            if (succ_g > old_succ_g ||
+                (succ_g == old_succ_g && search.iteration == old_iteration)) {
                 ++num_cache_hits;
                 continue;
             } else {
-                cache->add(succ_state, succ_g, iteration);
+                transposition_table->add(key, succ_g, search.iteration);
             }
         }
         int succ_h = compute_h_value(succ_state);
@@ -139,8 +234,8 @@ int IDAstarSearch::recursive_search(const IDAstarNode &node) {
         if (succ_h != INF) {
             operator_sequence.push_back(op_id);
             IDAstarNode succ_node(move(succ_state), succ_g, succ_h);
-            int rec_limit = recursive_search(succ_node);
-            if (found_solution() && single_plan) {
+            int rec_limit = recursive_search(succ_node, depth + 1);
+            if (search.plan_found && search.single_plan) {
                 return -1;
             }
             operator_sequence.pop_back();
@@ -150,19 +245,202 @@ int IDAstarSearch::recursive_search(const IDAstarNode &node) {
     return next_limit;
 }
 
+int IDAstarWorker::split(
+    const IDAstarNode &root, int depth, vector<WorkUnit> &units) {
+    assert(operator_sequence.empty());
+    split_depth = depth;
+    split_nodes = &units;
+    int next_limit = recursive_search(root, 0);
+    split_depth = -1;
+    split_nodes = nullptr;
+    operator_sequence.clear();
+    return next_limit;
+}
+
+void IDAstarWorker::add_work_unit(WorkUnit &&unit) {
+    lock_guard<mutex> lock(work_units_mutex);
+    work_units.push_back(move(unit));
+}
+
+optional<WorkUnit> IDAstarWorker::pop_work_unit() {
+    lock_guard<mutex> lock(work_units_mutex);
+    if (work_units.empty()) {
+        return nullopt;
+    }
+    WorkUnit unit = move(work_units.back());
+    work_units.pop_back();
+    return unit;
+}
+
+optional<WorkUnit> IDAstarWorker::steal_work_unit() {
+    int num_workers = search.workers.size();
+    for (int i = 1; i < num_workers; ++i) {
+        IDAstarWorker &victim = *search.workers[(id + i) % num_workers];
+        lock_guard<mutex> lock(victim.work_units_mutex);
+        if (!victim.work_units.empty()) {
+            WorkUnit unit = move(victim.work_units.front());
+            victim.work_units.pop_front();
+            return unit;
+        }
+    }
+    return nullopt;
+}
+
+void IDAstarWorker::run() {
+    auto start_time = chrono::steady_clock::now();
+    /* The threads only create work units before the parallel phase, so
+       we can stop as soon as no thread has units left. */
+    while (!(search.plan_found && search.single_plan)) {
+        optional<WorkUnit> unit = pop_work_unit();
+        if (!unit) {
+            unit = steal_work_unit();
+        }
+        if (!unit) {
+            break;
+        }
+        operator_sequence = move(unit->operator_sequence);
+        update_minimum(search.next_f_limit, recursive_search(unit->node, 0));
+        operator_sequence.clear();
+    }
+    busy_seconds += chrono::duration<double>(
+        chrono::steady_clock::now() - start_time).count();
+}
+
+
+IDAstarSearch::IDAstarSearch(const plugins::Options &opts)
+    : SearchAlgorithm(opts),
+      eval_config(opts.get<parser::LazyValue>("eval")),
+      single_plan(opts.get<bool>("single_plan")),
+      num_threads(opts.get<int>("threads")),
+      split_depth(opts.get<int>("split_depth")),
+      iteration(0),
+      f_limit(opts.get<int>("initial_f_limit")),
+      next_f_limit(INF),
+      cheapest_plan_cost(numeric_limits<int>::max()),
+      plan_found(false) {
+    if (num_threads > 1) {
+        // The threads would share the axiom evaluator, which isn't thread-safe.
+        task_properties::verify_no_axioms(task_proxy);
+    }
+    int cache_mb = opts.get<int>("cache_mb");
+    if (cache_mb > 0) {
+        transposition_table = utils::make_unique_ptr<TranspositionTable>(cache_mb);
+    }
+    set<Evaluator *> evaluators;
+    for (int i = 0; i < num_threads; ++i) {
+        shared_ptr<Evaluator> h_evaluator;
+        try {
+            h_evaluator = eval_config.construct<shared_ptr<Evaluator>>();
+        } catch (const utils::ContextError &e) {
+            cerr << "Delayed construction of LazyValue failed" << endl;
+            cerr << e.get_message() << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+        }
+        if (num_threads > 1 && h_evaluator->does_cache_estimates()) {
+            cerr << "Error: set cache_estimates=false for IDA* heuristics "
+                 << "with multiple threads." << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+        }
+        if (!evaluators.insert(h_evaluator.get()).second) {
+            cerr << "idastar() with multiple threads needs one evaluator per "
+                 << "thread. Don't use predefined evaluators for its eval "
+                 << "option." << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+        }
+        workers.push_back(utils::make_unique_ptr<IDAstarWorker>(
+                              *this, i, h_evaluator, transposition_table.get()));
+    }
+}
+
+IDAstarSearch::~IDAstarSearch() {
+}
+
+void IDAstarSearch::initialize() {
+    cout << "Conducting IDA* search";
+    if (num_threads > 1) {
+        cout << " with " << num_threads << " threads";
+    }
+    cout << ", (real) bound = " << bound << endl;
+}
+
+void IDAstarSearch::print_statistics() const {
+    uint64_t num_expansions = 0;
+    uint64_t num_evaluations = 0;
+    int num_cache_hits = 0;
+    vector<uint64_t> expansions_per_thread;
+    vector<int> expansions_per_second_per_thread;
+    for (const auto &worker : workers) {
+        num_expansions += worker->get_num_expansions();
+        num_evaluations += worker->get_num_evaluations();
+        num_cache_hits += worker->get_num_cache_hits();
+        expansions_per_thread.push_back(worker->get_num_expansions());
+        expansions_per_second_per_thread.push_back(static_cast<int>(
+            worker->get_num_expansions() / max(worker->get_busy_seconds(), 1e-9)));
+    }
+    cout << "Expansions: " << num_expansions << endl;
+    cout << "Evaluations: " << num_evaluations << endl;
+    cout << "IDA* cache hits: " << num_cache_hits << endl;
+    if (transposition_table) {
+        cout << "IDA* cache entries: " << transposition_table->count_used_entries()
+             << "/" << transposition_table->get_num_entries() << endl;
+    }
+    cout << "IDA* iterations: " << iteration << endl;
+    if (num_threads > 1) {
+        /* The main thread also expands the nodes above the split depth,
+           which we don't count as busy time. */
+        cout << "Expansions per thread: " << expansions_per_thread << endl;
+        cout << "Expansions per second per thread: "
+             << expansions_per_second_per_thread << endl;
+    }
+}
+
+void IDAstarSearch::report_plan(const Plan &plan) {
+    lock_guard<mutex> lock(plan_mutex);
+    if (plan_found && single_plan) {
+        // Another thread has found a plan in the meantime.
+        return;
+    }
+    int plan_cost = calculate_plan_cost(plan, task_proxy);
+    cout << "Found solution with cost " << plan_cost << endl;
+    if (plan_cost < cheapest_plan_cost) {
+        plan_manager.save_plan(plan, task_proxy, !single_plan);
+        cheapest_plan_cost = plan_cost;
+        set_plan(plan);
+        plan_found = true;
+        f_limit = plan_cost - 1;
+    }
+}
+
+int IDAstarSearch::search_in_parallel(const IDAstarNode &root) {
+    vector<WorkUnit> units;
+    next_f_limit = workers[0]->split(root, split_depth, units);
+    if (plan_found && single_plan) {
+        return next_f_limit;
+    }
+    int num_units = units.size();
+    for (int i = 0; i < num_units; ++i) {
+        workers[i % num_threads]->add_work_unit(move(units[i]));
+    }
+    utils::run_in_parallel(num_threads, [this](int thread_id) {
+                               workers[thread_id]->run();
+                           });
+    return next_f_limit;
+}
+
 SearchStatus IDAstarSearch::step() {
     cout << "IDA* search start time: " << utils::g_timer() << endl;
     State initial_state = task_proxy.get_initial_state();
-    int init_h = compute_h_value(initial_state);
+    int init_h = workers[0]->compute_h_value(initial_state);
     utils::g_log << "Initial h value: " << init_h << endl;
     IDAstarNode node(initial_state, 0, init_h);
-    while (f_limit != INF && f_limit != -1 && (!single_plan || !found_solution())) {
+    while (f_limit != INF && f_limit != -1 && (!single_plan || !plan_found)) {
         utils::g_log << "f limit: " << f_limit << endl;
         ++iteration;
-        f_limit = recursive_search(node);
-    }
-    if (utils::extra_memory_padding_is_reserved()) {
-        utils::release_extra_memory_padding();
+        if (num_threads == 1) {
+            f_limit = workers[0]->recursive_search(node, 0);
+        } else {
+            f_limit = search_in_parallel(node);
+        }
     }
     if (found_solution()) {
         return SOLVED;
@@ -179,27 +457,58 @@ class IDAstarSearchFeature
 public:
     IDAstarSearchFeature() : TypedFeature("idastar") {
         document_title("IDA* search");
-        document_synopsis("IDA* search with an optional g-value cache.");
+        document_synopsis(
+            "IDA* search with an optional transposition table that stores the "
+            "lowest g value of each seen state.");
         add_option<shared_ptr<Evaluator>>(
             "eval",
-            "evaluator for h-value. Make sure to use cache_estimates=false.");
+            "evaluator for h-value. IDA* doesn't register states, so cached "
+            "estimates are never used. With multiple threads, cache_estimates "
+            "must be false. The evaluator is constructed once for each thread, "
+            "so its preprocessing (e.g., computing the cost partitionings of "
+            "scp()) is repeated for each thread and it needs N times as much "
+            "memory for N threads.",
+            "",
+            plugins::Bounds::unlimited(),
+            true);
         add_option<int>(
             "initial_f_limit",
             "initial depth limit",
             "0",
             plugins::Bounds("0", "infinity"));
         add_option<int>(
-            "cache_size",
-            "maximum number of states to cache. For cache_size=infinity the cache "
-            "fills up until approaching the memory limit, at which point the "
-            "current number of states becomes the maximum cache size.",
+            "cache_mb",
+            "size of the transposition table in MB (0 disables it)",
             "0",
             plugins::Bounds("0", "infinity"));
         add_option<bool>(
             "single_plan",
             "stop after finding the first plan",
             "true");
+        add_option<int>(
+            "threads",
+            "number of threads",
+            "1",
+            plugins::Bounds("1", "infinity"));
+        add_option<int>(
+            "split_depth",
+            "with multiple threads, split each iteration into the subtrees "
+            "rooted at this depth and distribute them among the threads",
+            "5",
+            plugins::Bounds("1", "infinity"));
         SearchAlgorithm::add_options_to_feature(*this);
+
+        document_language_support("action costs", "supported");
+        document_language_support("conditional effects", "supported");
+        document_language_support("axioms", "only supported with threads=1");
+
+        document_note(
+            "Threads",
+            "Each thread uses its own evaluator, but all threads share the "
+            "transposition table. The evaluators of "
+            "different threads must not share mutable state, which holds for "
+            "all heuristics that only read data computed during their "
+            "construction.");
     }
 };
 
@@ -3,10 +3,12 @@
 
 #include "../search_algorithm.h"
 
-#include "../utils/hash.h"
+#include "../parser/decorated_abstract_syntax_tree.h"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
-#include <queue>
+#include <mutex>
 #include <vector>
 
 class Evaluator;
@@ -16,6 +18,8 @@ class Options;
 }
 
 namespace idastar_search {
+class IDAstarWorker;
+
 struct IDAstarNode {
     State state;
     int g;
@@ -29,37 +33,76 @@ struct IDAstarNode {
 };
 
 using CacheValue = std::pair<int, int>;
-class FifoCache {
-    int max_size;
-    utils::HashMap<State, CacheValue> state_to_g_and_iteration;
-    std::queue<State> states;
+
+/*
+  Fixed-size transposition table that stores the lowest g value with which
+  IDA* reached a state and the iteration in which this happened.
+
+  The table is open-addressed and consists of buckets of four entries, which
+  fit into one cache line. Each entry only stores the 64-bit hash value of
+  its state, so hash collisions can (very rarely) prune states that have not
+  been seen. If a bucket is full, we replace the entry from the oldest
+  iteration and break ties in favor of replacing the entry with the highest g
+  value, because it usually prunes the smallest subtree.
+
+  Threads may access the table concurrently without locks. Each entry stores
+  its key XORed with its data, so lookups treat entries that are written
+  concurrently as missing (Hyatt and Mann, ICGA Journal 2002).
+*/
+class TranspositionTable {
+    struct Entry {
+        std::atomic<uint64_t> key_xor_data;
+        // Zero for empty entries.
+        std::atomic<uint64_t> data;
+    };
+    static const int BUCKET_SIZE = 4;
+
+    std::vector<Entry> entries;
+    uint64_t bucket_mask;
+
+    Entry *get_bucket(uint64_t key) {
+        return &entries[(key & bucket_mask) * BUCKET_SIZE];
+    }
 
 public:
-    explicit FifoCache(int max_size);
+    explicit TranspositionTable(int size_in_mb);
 
-    void add(const State &state, int g, int iteration);
-    CacheValue lookup(const State &state) const;
-    void clear();
+    void add(uint64_t key, int g, int iteration);
+    CacheValue lookup(uint64_t key);
+
+    size_t get_num_entries() const;
+    size_t count_used_entries() const;
 };
 
+/*
+  With multiple threads, each iteration first expands the search tree up to
+  the split depth in the main thread. The nodes at the split depth become work
+  units, which we distribute round-robin among the threads. Each thread
+  searches its own units depth-first and steals units from other threads
+  once it runs out of work. The threads combine the f limits for the next
+  iteration with an atomic minimum. Each thread uses its own evaluator.
+*/
 class IDAstarSearch : public SearchAlgorithm {
-    const std::shared_ptr<Evaluator> h_evaluator;
+    friend class IDAstarWorker;
+
+    const parser::LazyValue eval_config;
     const bool single_plan;
+    const int num_threads;
+    const int split_depth;
 
     int iteration;
-    int f_limit;
-    Plan operator_sequence;
+    std::atomic<int> f_limit;
+    std::atomic<int> next_f_limit;
     int cheapest_plan_cost;
+    std::atomic<bool> plan_found;
+    std::mutex plan_mutex;
 
-    // Store last seen states and their g values in FIFO queue.
-    std::unique_ptr<FifoCache> cache;
-    int num_cache_hits;
-
-    uint64_t num_expansions;
-    uint64_t num_evaluations;
+    // All threads share the transposition table.
+    std::unique_ptr<TranspositionTable> transposition_table;
+    std::vector<std::unique_ptr<IDAstarWorker>> workers;
 
-    int compute_h_value(const State &state) const;
-    int recursive_search(const IDAstarNode &node);
+    void report_plan(const Plan &plan);
+    int search_in_parallel(const IDAstarNode &root);
 
 protected:
     virtual void initialize() override;
@@ -67,6 +110,7 @@ protected:
 
 public:
     explicit IDAstarSearch(const plugins::Options &opts);
+    virtual ~IDAstarSearch() override;
 
     void save_plan_if_necessary() override;
 
@@ -14,6 +14,7 @@ namespace iterative_width_search {
 IterativeWidthSearch::IterativeWidthSearch(const plugins::Options &opts)
     : SearchAlgorithm(opts),
       width(opts.get<int>("width")),
+      register_only_novel_states(opts.get<bool>("register_only_novel_states")),
       debug(opts.get<utils::Verbosity>("verbosity") == utils::Verbosity::DEBUG),
       novelty_table(task_proxy, width) {
     utils::g_log << "Setting up iterative width search." << endl;
@@ -43,6 +44,8 @@ void IterativeWidthSearch::print_statistics() const {
     novelty_table.print_statistics();
     statistics.print_detailed_statistics();
     search_space.print_statistics();
+    utils::g_log << "Registered " << state_registry.size() << " of "
+                 << statistics.get_generated() << " generated states" << endl;
 }
 
 SearchStatus IterativeWidthSearch::step() {
@@ -62,6 +65,9 @@ SearchStatus IterativeWidthSearch::step() {
         return SOLVED;
     }
 
+    if (register_only_novel_states) {
+        state.unpack();
+    }
     vector<OperatorID> applicable_ops;
     successor_generator.generate_applicable_ops(state, applicable_ops);
     for (OperatorID op_id : applicable_ops) {
@@ -70,7 +76,9 @@ SearchStatus IterativeWidthSearch::step() {
             continue;
         }
 
-        State succ_state = state_registry.get_successor_state(state, op);
+        State succ_state = register_only_novel_states
+            ? state.get_unregistered_successor(op)
+            : state_registry.get_successor_state(state, op);
         statistics.inc_generated();
 
         bool novel = is_novel(op, succ_state);
@@ -79,6 +87,11 @@ SearchStatus IterativeWidthSearch::step() {
             continue;
         }
 
+        if (register_only_novel_states) {
+            /* A novel state contains an unseen fact or fact pair, so it
+               can't be registered already. */
+            succ_state = state_registry.register_state(succ_state);
+        }
         SearchNode succ_node = search_space.get_node(succ_state);
         assert(succ_node.is_new());
         succ_node.open(node, op, get_adjusted_cost(op));
@@ -99,6 +112,12 @@ public:
         document_title("Iterated width search");
         add_option<int>(
             "width", "maximum conjunction size", "2", plugins::Bounds("1", "2"));
+        add_option<bool>(
+            "register_only_novel_states",
+            "test the novelty of unregistered successor states and only "
+            "register novel states. This saves memory if most generated "
+            "states are not novel.",
+            "false");
         SearchAlgorithm::add_options_to_feature(*this);
     }
 };
@@ -17,6 +17,7 @@ class Options;
 namespace iterative_width_search {
 class IterativeWidthSearch : public SearchAlgorithm {
     const int width;
+    const bool register_only_novel_states;
     const bool debug;
 
     std::deque<StateID> open_list;
@@ -0,0 +1,182 @@
+#include "novelty_benchmark.h"
+
+#include "../novelty/novelty_table.h"
+#include "../plugins/plugin.h"
+#include "../utils/logging.h"
+#include "../utils/timer.h"
+
+using namespace std;
+
+namespace novelty_benchmark {
+/*
+  Straightforward novelty table that tests and updates each fact pair of a
+  state individually. This was our implementation before we switched to
+  the bit matrix in novelty::NoveltyTable.
+*/
+class ReferenceNoveltyTable {
+    const int width;
+    novelty::FactIndexer fact_indexer;
+    vector<bool> seen_facts;
+    vector<bool> seen_fact_pairs;
+
+    void update(const FactPair &fact, int &novelty) {
+        int fact_id = fact_indexer.get_fact_id(fact);
+        if (!seen_facts[fact_id]) {
+            seen_facts[fact_id] = true;
+            novelty = 1;
+        }
+    }
+
+    void update(const FactPair &fact1, const FactPair &fact2, int &novelty) {
+        int pair_id = fact_indexer.get_pair_id(fact1, fact2);
+        if (!seen_fact_pairs[pair_id]) {
+            seen_fact_pairs[pair_id] = true;
+            novelty = min(novelty, 2);
+        }
+    }
+
+public:
+    ReferenceNoveltyTable(const TaskProxy &task_proxy, int width)
+        : width(width),
+          fact_indexer(task_proxy),
+          seen_facts(fact_indexer.get_num_facts(), false) {
+        if (width == 2) {
+            seen_fact_pairs.assign(fact_indexer.get_num_pairs(), false);
+        }
+    }
+
+    int compute_novelty_and_update_table(const State &state) {
+        int num_vars = state.size();
+        int novelty = novelty::NoveltyTable::UNKNOWN_NOVELTY;
+        for (int var1 = 0; var1 < num_vars; ++var1) {
+            FactPair fact1 = state[var1].get_pair();
+            update(fact1, novelty);
+            for (int var2 = var1 + 1; width == 2 && var2 < num_vars; ++var2) {
+                update(fact1, state[var2].get_pair(), novelty);
+            }
+        }
+        return novelty;
+    }
+
+    int compute_novelty_and_update_table(
+        const OperatorProxy &op, const State &succ_state) {
+        int num_vars = succ_state.size();
+        int novelty = novelty::NoveltyTable::UNKNOWN_NOVELTY;
+        for (EffectProxy effect : op.get_effects()) {
+            FactPair fact1 = effect.get_fact().get_pair();
+            update(fact1, novelty);
+            for (int var2 = 0; width == 2 && var2 < num_vars; ++var2) {
+                if (var2 != fact1.var) {
+                    update(fact1, succ_state[var2].get_pair(), novelty);
+                }
+            }
+        }
+        return novelty;
+    }
+};
+
+NoveltyBenchmark::NoveltyBenchmark(const plugins::Options &opts)
+    : Benchmark(opts, "novelty tables"),
+      width(opts.get<int>("width")),
+      max_states(opts.get<int>("max_states")) {
+}
+
+void NoveltyBenchmark::run_complete_state_benchmark() {
+    vector<State> states;
+    for (StateID id : state_registry) {
+        states.push_back(state_registry.lookup_state(id));
+        states.back().unpack();
+    }
+
+    ReferenceNoveltyTable reference_table(task_proxy, width);
+    vector<int> reference_novelties;
+    reference_novelties.reserve(states.size());
+    utils::Timer reference_timer;
+    for (const State &state : states) {
+        reference_novelties.push_back(reference_table.compute_novelty_and_update_table(state));
+    }
+    reference_timer.stop();
+
+    novelty::NoveltyTable table(task_proxy, width);
+    vector<int> novelties;
+    novelties.reserve(states.size());
+    utils::Timer timer;
+    for (const State &state : states) {
+        novelties.push_back(table.compute_novelty_and_update_table(state));
+    }
+    timer.stop();
+
+    check(novelties == reference_novelties,
+          "Novelty tables computed different novelty values.");
+    log << "Complete states: reference table " << reference_timer
+        << ", novelty table " << timer << endl;
+}
+
+void NoveltyBenchmark::run_incremental_benchmark() {
+    vector<State> succ_states;
+    for (const Transition &transition : transitions) {
+        succ_states.push_back(state_registry.lookup_state(transition.succ_id));
+        succ_states.back().unpack();
+    }
+    OperatorsProxy operators = task_proxy.get_operators();
+
+    ReferenceNoveltyTable reference_table(task_proxy, width);
+    vector<int> reference_novelties;
+    reference_novelties.reserve(transitions.size());
+    utils::Timer reference_timer;
+    for (size_t i = 0; i < transitions.size(); ++i) {
+        reference_novelties.push_back(reference_table.compute_novelty_and_update_table(
+                                          operators[transitions[i].op_id], succ_states[i]));
+    }
+    reference_timer.stop();
+
+    novelty::NoveltyTable table(task_proxy, width);
+    vector<int> novelties;
+    novelties.reserve(transitions.size());
+    utils::Timer timer;
+    for (size_t i = 0; i < transitions.size(); ++i) {
+        novelties.push_back(table.compute_novelty_and_update_table(
+                                operators[transitions[i].op_id], succ_states[i]));
+    }
+    timer.stop();
+
+    check(novelties == reference_novelties,
+          "Novelty tables computed different novelty values.");
+    log << "Transitions: reference table " << reference_timer
+        << ", novelty table " << timer << endl;
+}
+
+void NoveltyBenchmark::run_benchmark() {
+    collect_states(
+        max_states,
+        [this](const State &parent, OperatorID op_id, const State &succ) {
+            transitions.emplace_back(parent.get_id(), op_id, succ.get_id());
+        });
+    run_complete_state_benchmark();
+    run_incremental_benchmark();
+}
+
+class NoveltyBenchmarkFeature
+    : public plugins::TypedFeature<SearchAlgorithm, NoveltyBenchmark> {
+public:
+    NoveltyBenchmarkFeature() : TypedFeature("novelty_benchmark") {
+        document_title("Novelty table benchmark");
+        document_synopsis(
+            "Collects reachable states with a breadth-first search and "
+            "measures how long the novelty table and a reference "
+            "implementation that tests fact pairs individually need for "
+            "computing their novelty.");
+
+        add_option<int>(
+            "width", "maximum conjunction size", "2", plugins::Bounds("1", "2"));
+        add_option<int>(
+            "max_states",
+            "maximum number of states to collect",
+            "100000",
+            plugins::Bounds("1", "infinity"));
+        benchmark::add_benchmark_options_to_feature(*this);
+    }
+};
+
+static plugins::FeaturePlugin<NoveltyBenchmarkFeature> _plugin;
+}
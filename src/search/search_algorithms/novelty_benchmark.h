@@ -0,0 +1,45 @@
+#ifndef SEARCH_ALGORITHMS_NOVELTY_BENCHMARK_H
+#define SEARCH_ALGORITHMS_NOVELTY_BENCHMARK_H
+
+#include "benchmark.h"
+
+#include <vector>
+
+namespace novelty_benchmark {
+struct Transition {
+    StateID parent_id;
+    OperatorID op_id;
+    StateID succ_id;
+
+    Transition(StateID parent_id, OperatorID op_id, StateID succ_id)
+        : parent_id(parent_id), op_id(op_id), succ_id(succ_id) {
+    }
+};
+
+/*
+  Compare the running time of novelty::NoveltyTable with a reference
+  implementation that tests each fact pair individually.
+
+  We collect up to max_states reachable states with a breadth-first search
+  and then compute the novelty of all states, once for complete states and
+  once incrementally for all transitions that generated them. The benchmark
+  also checks that both implementations compute the same novelty values.
+*/
+class NoveltyBenchmark : public benchmark::Benchmark {
+    const int width;
+    const int max_states;
+
+    std::vector<Transition> transitions;
+
+    void run_complete_state_benchmark();
+    void run_incremental_benchmark();
+
+protected:
+    virtual void run_benchmark() override;
+
+public:
+    explicit NoveltyBenchmark(const plugins::Options &opts);
+};
+}
+
+#endif
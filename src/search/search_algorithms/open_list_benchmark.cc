@@ -0,0 +1,190 @@
+#include "open_list_benchmark.h"
+
+#include "../evaluator.h"
+
+#include "../open_lists/bucket_open_list.h"
+#include "../open_lists/tiebreaking_open_list.h"
+#include "../plugins/plugin.h"
+#include "../task_utils/successor_generator.h"
+#include "../utils/logging.h"
+#include "../utils/timer.h"
+
+using namespace std;
+
+namespace open_list_benchmark {
+static plugins::Options get_open_list_options(const plugins::Options &opts) {
+    plugins::Options open_list_opts(opts);
+    open_list_opts.set<bool>("pref_only", false);
+    return open_list_opts;
+}
+
+OpenListBenchmark::OpenListBenchmark(const plugins::Options &opts)
+    : Benchmark(opts, "open lists"),
+      max_states(opts.get<int>("max_states")),
+      repetitions(opts.get<int>("repetitions")),
+      reference_factory(
+          make_shared<tiebreaking_open_list::TieBreakingOpenListFactory>(
+              get_open_list_options(opts))),
+      bucket_factory(
+          make_shared<bucket_open_list::BucketOpenListFactory>(
+              get_open_list_options(opts))),
+      evaluators(opts.get_list<shared_ptr<Evaluator>>("evals")),
+      state_index(-1) {
+}
+
+void OpenListBenchmark::collect_states() {
+    vector<int> g_values;
+    State initial_state = state_registry.get_initial_state();
+    state_index[initial_state] = 0;
+    state_ids.push_back(initial_state.get_id());
+    g_values.push_back(0);
+    successors.emplace_back();
+    vector<OperatorID> applicable_ops;
+    // The collected states form the queue of the breadth-first search.
+    for (size_t i = 0; i < state_ids.size(); ++i) {
+        State state = state_registry.lookup_state(state_ids[i]);
+        applicable_ops.clear();
+        successor_generator.generate_applicable_ops(state, applicable_ops);
+        for (OperatorID op_id : applicable_ops) {
+            OperatorProxy op = task_proxy.get_operators()[op_id];
+            State succ_state = state_registry.get_successor_state(state, op);
+            int succ_index = state_index[succ_state];
+            if (succ_index == -1) {
+                if (static_cast<int>(state_ids.size()) == max_states) {
+                    continue;
+                }
+                succ_index = state_ids.size();
+                state_index[succ_state] = succ_index;
+                state_ids.push_back(succ_state.get_id());
+                g_values.push_back(g_values[i] + get_adjusted_cost(op));
+                successors.emplace_back();
+            }
+            successors[i].push_back(succ_index);
+        }
+    }
+    log << "Collected " << state_ids.size() << " states." << endl;
+
+    utils::Timer evaluation_timer;
+    eval_contexts.reserve(state_ids.size());
+    for (size_t i = 0; i < state_ids.size(); ++i) {
+        eval_contexts.emplace_back(
+            state_registry.lookup_state(state_ids[i]), g_values[i], false,
+            &statistics);
+        for (const shared_ptr<Evaluator> &evaluator : evaluators) {
+            eval_contexts.back().get_evaluator_value_or_infinity(evaluator.get());
+        }
+    }
+    log << "Time for evaluating states: " << evaluation_timer << endl;
+}
+
+void OpenListBenchmark::record_operations() {
+    unique_ptr<StateOpenList> open_list = reference_factory->create_state_open_list();
+    vector<bool> closed(state_ids.size(), false);
+    open_list->insert(eval_contexts[0], state_ids[0]);
+    operations.push_back(0);
+    while (!open_list->empty()) {
+        StateID id = open_list->remove_min();
+        operations.push_back(-1);
+        int index = state_index[state_registry.lookup_state(id)];
+        if (closed[index]) {
+            continue;
+        }
+        closed[index] = true;
+        for (int succ_index : successors[index]) {
+            if (!closed[succ_index] &&
+                !open_list->is_dead_end(eval_contexts[succ_index])) {
+                open_list->insert(eval_contexts[succ_index], state_ids[succ_index]);
+                operations.push_back(succ_index);
+            }
+        }
+    }
+    log << "Recorded " << operations.size() << " open list operations." << endl;
+}
+
+vector<StateID> OpenListBenchmark::replay_operations(StateOpenList &open_list) {
+    vector<StateID> removed_ids;
+    removed_ids.reserve(operations.size());
+    for (int operation : operations) {
+        if (operation == -1) {
+            removed_ids.push_back(open_list.remove_min());
+        } else {
+            open_list.insert(eval_contexts[operation], state_ids[operation]);
+        }
+    }
+    return removed_ids;
+}
+
+void OpenListBenchmark::run_benchmark() {
+    collect_states();
+    record_operations();
+
+    utils::Timer reference_timer(false);
+    utils::Timer bucket_timer(false);
+    for (int i = 0; i < repetitions; ++i) {
+        unique_ptr<StateOpenList> reference_list =
+            reference_factory->create_state_open_list();
+        reference_timer.resume();
+        vector<StateID> reference_ids = replay_operations(*reference_list);
+        reference_timer.stop();
+
+        unique_ptr<StateOpenList> bucket_list =
+            bucket_factory->create_state_open_list();
+        bucket_timer.resume();
+        vector<StateID> bucket_ids = replay_operations(*bucket_list);
+        bucket_timer.stop();
+
+        check(bucket_ids == reference_ids,
+              "Open lists returned entries in different orders.");
+    }
+    log << "Tie-breaking open list: " << reference_timer << endl;
+    log << "Bucket open list: " << bucket_timer << endl;
+}
+
+class OpenListBenchmarkFeature
+    : public plugins::TypedFeature<SearchAlgorithm, OpenListBenchmark> {
+public:
+    OpenListBenchmarkFeature() : TypedFeature("open_list_benchmark") {
+        document_title("Open list benchmark");
+        document_synopsis(
+            "Collects reachable states with a breadth-first search, records "
+            "the open list operations of a best-first search over these "
+            "states and measures how long the tie-breaking and the bucket "
+            "open list need for them.");
+
+        add_list_option<shared_ptr<Evaluator>>(
+            "evals", "one or two evaluators (primary key and tie-breaker)");
+        add_option<bool>(
+            "unsafe_pruning",
+            "allow unsafe pruning when the main evaluator regards a state a dead end",
+            "true");
+        add_option<int>(
+            "max_buckets_per_entry",
+            "maximum number of buckets per entry in the bucket arrays of the "
+            "bucket open list",
+            "4",
+            plugins::Bounds("0", "infinity"));
+        add_option<int>(
+            "max_states",
+            "maximum number of states to collect",
+            "100000",
+            plugins::Bounds("1", "infinity"));
+        add_option<int>(
+            "repetitions",
+            "number of times we replay the open list operations",
+            "10",
+            plugins::Bounds("1", "infinity"));
+        benchmark::add_benchmark_options_to_feature(*this);
+    }
+
+    virtual shared_ptr<OpenListBenchmark> create_component(
+        const plugins::Options &options, const utils::Context &context) const override {
+        plugins::verify_list_non_empty<shared_ptr<Evaluator>>(context, options, "evals");
+        if (options.get_list<shared_ptr<Evaluator>>("evals").size() > 2) {
+            context.error("Bucket open lists support at most two evaluators.");
+        }
+        return make_shared<OpenListBenchmark>(options);
+    }
+};
+
+static plugins::FeaturePlugin<OpenListBenchmarkFeature> _plugin;
+}
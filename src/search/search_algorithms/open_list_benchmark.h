@@ -0,0 +1,51 @@
+#ifndef SEARCH_ALGORITHMS_OPEN_LIST_BENCHMARK_H
+#define SEARCH_ALGORITHMS_OPEN_LIST_BENCHMARK_H
+
+#include "benchmark.h"
+
+#include "../open_list.h"
+#include "../per_state_information.h"
+
+#include <memory>
+#include <vector>
+
+class OpenListFactory;
+
+namespace open_list_benchmark {
+/*
+  Compare the running time of the bucket-based open list with the
+  tie-breaking open list for the same evaluators.
+
+  We collect up to max_states reachable states with a breadth-first search
+  and evaluate them up front. Then we record the insertions and removals of
+  a best-first search (without reopening) over these states and replay them
+  repetitions times with both open lists. The benchmark also checks that
+  both open lists return the entries in the same order.
+*/
+class OpenListBenchmark : public benchmark::Benchmark {
+    const int max_states;
+    const int repetitions;
+    std::shared_ptr<OpenListFactory> reference_factory;
+    std::shared_ptr<OpenListFactory> bucket_factory;
+    std::vector<std::shared_ptr<Evaluator>> evaluators;
+
+    std::vector<StateID> state_ids;
+    PerStateInformation<int> state_index;
+    std::vector<std::vector<int>> successors;
+    std::vector<EvaluationContext> eval_contexts;
+    // Non-negative values are insertions of states, -1 is a removal.
+    std::vector<int> operations;
+
+    void collect_states();
+    void record_operations();
+    std::vector<StateID> replay_operations(StateOpenList &open_list);
+
+protected:
+    virtual void run_benchmark() override;
+
+public:
+    explicit OpenListBenchmark(const plugins::Options &opts);
+};
+}
+
+#endif
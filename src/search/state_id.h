@@ -17,6 +17,7 @@ class ExhaustiveSearch;
 class StateID {
     friend class breadth_first_search::BreadthFirstSearch;
     friend class exhaustive_search::ExhaustiveSearch;
+    friend class ConcurrentStateRegistry;
     friend class StateRegistry;
     friend std::ostream &operator<<(std::ostream &os, StateID id);
     template<typename>
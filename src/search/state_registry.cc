@@ -8,16 +8,25 @@
 
 using namespace std;
 
-StateRegistry::StateRegistry(const TaskProxy &task_proxy)
+StateRegistry::StateRegistry(const TaskProxy &task_proxy, bool use_fingerprints)
     : task_proxy(task_proxy),
       state_packer(task_properties::g_state_packers[task_proxy]),
       axiom_evaluator(g_axiom_evaluators[task_proxy]),
       num_variables(task_proxy.get_variables().size()),
       state_data_pool(get_bins_per_state()),
-      registered_states(
-          0,
-          StateIDSemanticHash(state_data_pool, get_bins_per_state()),
-          StateIDSemanticEqual(state_data_pool, get_bins_per_state())) {
+      registered_states(create_state_set(use_fingerprints)) {
+}
+
+variant<StateRegistry::StateIDSet, StateRegistry::FingerprintedStateIDSet>
+StateRegistry::create_state_set(bool use_fingerprints) {
+    StateIDSemanticEqual state_equal(state_data_pool, get_bins_per_state());
+    if (use_fingerprints) {
+        return FingerprintedStateIDSet(
+            0, FingerprintHash(),
+            FingerprintedStateIDSemanticEqual(state_equal, deduplication_statistics));
+    }
+    return StateIDSet(
+        0, StateIDSemanticHash(state_data_pool, get_bins_per_state()), state_equal);
 }
 
 StateID StateRegistry::insert_id_or_pop_state() {
@@ -28,12 +37,24 @@ StateID StateRegistry::insert_id_or_pop_state() {
       state data pool.
     */
     StateID id(state_data_pool.size() - 1);
-    auto result = registered_states.insert(id.value);
+    if (auto *fingerprinted_states = get_if<FingerprintedStateIDSet>(&registered_states)) {
+        ++deduplication_statistics.num_lookups;
+        uint64_t hash = StateIDSemanticHash(state_data_pool, get_bins_per_state())(id.value);
+        uint32_t fingerprint = static_cast<uint32_t>(hash ^ (hash >> 32));
+        auto result = fingerprinted_states->insert({id.value, fingerprint});
+        if (!result.second) {
+            state_data_pool.pop_back();
+        }
+        assert(fingerprinted_states->size() == state_data_pool.size());
+        return StateID(result.first->id);
+    }
+    StateIDSet &state_ids = get<StateIDSet>(registered_states);
+    auto result = state_ids.insert(id.value);
     bool is_new_entry = result.second;
     if (!is_new_entry) {
         state_data_pool.pop_back();
     }
-    assert(registered_states.size() == state_data_pool.size());
+    assert(state_ids.size() == state_data_pool.size());
     return StateID(*result.first);
 }
 
@@ -116,6 +137,23 @@ State StateRegistry::get_successor_state(const State &predecessor, const Operato
     }
 }
 
+State StateRegistry::register_state(const PackedStateBin *buffer) {
+    state_data_pool.push_back(buffer);
+    StateID id = insert_id_or_pop_state();
+    return lookup_state(id);
+}
+
+State StateRegistry::register_state(const State &unregistered_state) {
+    assert(!unregistered_state.get_registry());
+    // Avoid garbage values in half-full bins.
+    vector<PackedStateBin> buffer(get_bins_per_state(), 0);
+    const vector<int> &values = unregistered_state.get_unpacked_values();
+    for (size_t var = 0; var < values.size(); ++var) {
+        state_packer.set(buffer.data(), var, values[var]);
+    }
+    return register_state(buffer.data());
+}
+
 int StateRegistry::get_bins_per_state() const {
     return state_packer.get_num_bins();
 }
@@ -126,7 +164,28 @@ int StateRegistry::get_state_size_in_bytes() const {
 
 void StateRegistry::print_statistics(utils::LogProxy &log) const {
     log << "Number of registered states: " << size() << endl;
-    log << "Closed list load factor: " << registered_states.size()
-        << "/" << registered_states.capacity() << " = "
-        << registered_states.load_factor() << endl;
+    visit([&log](const auto &states) {
+              log << "Closed list load factor: " << states.size()
+                  << "/" << states.capacity() << " = "
+                  << states.load_factor() << endl;
+          }, registered_states);
+    if (holds_alternative<FingerprintedStateIDSet>(registered_states)) {
+        const DeduplicationStatistics &stats = deduplication_statistics;
+        log << "Closed list lookups: " << stats.num_lookups << endl;
+        log << "Closed list key comparisons: " << stats.num_key_comparisons << endl;
+        log << "Closed list comparisons decided by fingerprint: "
+            << stats.num_fingerprint_rejections << endl;
+        log << "Closed list fingerprint collisions: "
+            << stats.num_fingerprint_collisions << endl;
+        if (stats.num_lookups > 0) {
+            log << "Closed list key comparisons per lookup: "
+                << static_cast<double>(stats.num_key_comparisons) / stats.num_lookups
+                << endl;
+        }
+        if (stats.num_key_comparisons > 0) {
+            log << "Closed list fingerprint hit rate: "
+                << static_cast<double>(stats.num_fingerprint_rejections)
+                / stats.num_key_comparisons << endl;
+        }
+    }
 }
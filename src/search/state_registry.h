@@ -13,6 +13,7 @@
 #include <parallel_hashmap/phmap.h>
 
 #include <set>
+#include <variant>
 
 /*
   Overview of classes relevant to storing and working with registered states.
@@ -118,6 +119,19 @@ using PackedStateBin = int_packer::IntPacker::Bin;
 
 
 class StateRegistry : public subscriber::SubscriberService<StateRegistry> {
+    /*
+      Counters for analyzing the cost of duplicate detection with
+      fingerprints. The hash set only compares keys whose 7-bit control byte
+      matches, so the number of key comparisons per lookup measures how often
+      probing has to look at a candidate entry.
+    */
+    struct DeduplicationStatistics {
+        int64_t num_lookups = 0;
+        int64_t num_key_comparisons = 0;
+        int64_t num_fingerprint_rejections = 0;
+        int64_t num_fingerprint_collisions = 0;
+    };
+
     struct StateIDSemanticHash {
         const segmented_vector::SegmentedArrayVector<PackedStateBin> &state_data_pool;
         int state_size;
@@ -155,12 +169,58 @@ class StateRegistry : public subscriber::SubscriberService<StateRegistry> {
         }
     };
 
+    /*
+      A StateID together with 32 bits of the hash value of its state. Hashing
+      these entries only uses the fingerprint, so growing the hash set doesn't
+      need to read the packed states. Comparing fingerprints first avoids
+      reading the state pool for most non-equal entries.
+    */
+    struct FingerprintedStateID {
+        int id;
+        uint32_t fingerprint;
+    };
+
+    struct FingerprintHash {
+        uint64_t operator()(const FingerprintedStateID &entry) const {
+            // The hash set mixes the bits of the hash value itself.
+            return entry.fingerprint;
+        }
+    };
+
+    struct FingerprintedStateIDSemanticEqual {
+        StateIDSemanticEqual state_equal;
+        DeduplicationStatistics &statistics;
+        FingerprintedStateIDSemanticEqual(
+            const StateIDSemanticEqual &state_equal,
+            DeduplicationStatistics &statistics)
+            : state_equal(state_equal),
+              statistics(statistics) {
+        }
+
+        bool operator()(
+            const FingerprintedStateID &lhs, const FingerprintedStateID &rhs) const {
+            ++statistics.num_key_comparisons;
+            if (lhs.fingerprint != rhs.fingerprint) {
+                ++statistics.num_fingerprint_rejections;
+                return false;
+            }
+            bool equal = state_equal(lhs.id, rhs.id);
+            if (!equal) {
+                ++statistics.num_fingerprint_collisions;
+            }
+            return equal;
+        }
+    };
+
     /*
       Hash set of StateIDs used to detect states that are already registered in
       this registry and find their IDs. States are compared/hashed semantically,
       i.e. the actual state data is compared, not the memory location.
     */
     using StateIDSet = phmap::flat_hash_set<int, StateIDSemanticHash, StateIDSemanticEqual>;
+    // Like StateIDSet, but caches a fingerprint of each state (see above).
+    using FingerprintedStateIDSet = phmap::flat_hash_set<
+        FingerprintedStateID, FingerprintHash, FingerprintedStateIDSemanticEqual>;
 
     TaskProxy task_proxy;
     const int_packer::IntPacker &state_packer;
@@ -168,14 +228,25 @@ class StateRegistry : public subscriber::SubscriberService<StateRegistry> {
     const int num_variables;
 
     segmented_vector::SegmentedArrayVector<PackedStateBin> state_data_pool;
-    StateIDSet registered_states;
+    // Only used with fingerprints.
+    DeduplicationStatistics deduplication_statistics;
+    std::variant<StateIDSet, FingerprintedStateIDSet> registered_states;
 
     std::unique_ptr<State> cached_initial_state;
 
+    std::variant<StateIDSet, FingerprintedStateIDSet> create_state_set(
+        bool use_fingerprints);
     StateID insert_id_or_pop_state();
     int get_bins_per_state() const;
 public:
-    explicit StateRegistry(const TaskProxy &task_proxy);
+    /*
+      If use_fingerprints is true, the hash set for duplicate detection stores
+      a 32-bit fingerprint of each state next to its ID. This needs twice the
+      memory for the hash set, but avoids most accesses to the packed states
+      when the hash set grows and when entries differ.
+    */
+    explicit StateRegistry(
+        const TaskProxy &task_proxy, bool use_fingerprints = false);
 
     const TaskProxy &get_task_proxy() const {
         return task_proxy;
@@ -215,11 +286,26 @@ public:
     */
     State get_successor_state(const State &predecessor, const OperatorProxy &op);
 
+    /*
+      Registers the state with the given packed data if this was not done
+      before and returns it. The data must have been packed with the state
+      packer of this registry's task, e.g., by another registry for the same
+      task. Like get_successor_state, this includes duplicate checking.
+    */
+    State register_state(const PackedStateBin *buffer);
+
+    /*
+      Like above, but registers an unregistered state of this registry's
+      task, e.g., one created with State::get_unregistered_successor.
+    */
+    State register_state(const State &unregistered_state);
+
     /*
       Returns the number of states registered so far.
     */
     size_t size() const {
-        return registered_states.size();
+        return std::visit(
+            [](const auto &states) {return states.size();}, registered_states);
     }
 
     int get_state_size_in_bytes() const;
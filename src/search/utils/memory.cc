@@ -2,19 +2,31 @@
 
 #include "../utils/logging.h"
 
+#include <atomic>
 #include <cassert>
 #include <iostream>
 
 using namespace std;
 
 namespace utils {
-static char *extra_memory_padding = nullptr;
+/*
+  Threads that build abstractions concurrently may run out of memory at the
+  same time, so the padding is released atomically.
+*/
+static atomic<char *> extra_memory_padding(nullptr);
 
 // Save standard out-of-memory handler.
 static void (*standard_out_of_memory_handler)() = nullptr;
 
 static void continuing_out_of_memory_handler() {
-    release_extra_memory_padding();
+    char *padding = extra_memory_padding.exchange(nullptr);
+    if (!padding) {
+        /* Another thread has already released the padding and is about to
+           restore the standard handler. Let operator new retry. */
+        return;
+    }
+    delete[] padding;
+    set_new_handler(standard_out_of_memory_handler);
     utils::g_log << "Failed to allocate memory. Released extra memory padding." << endl;
 }
 
@@ -25,14 +37,14 @@ void reserve_extra_memory_padding(int memory_in_mb) {
 }
 
 void release_extra_memory_padding() {
-    assert(extra_memory_padding);
-    delete[] extra_memory_padding;
-    extra_memory_padding = nullptr;
+    char *padding = extra_memory_padding.exchange(nullptr);
+    assert(padding);
+    delete[] padding;
     assert(standard_out_of_memory_handler);
     set_new_handler(standard_out_of_memory_handler);
 }
 
 bool extra_memory_padding_is_reserved() {
-    return extra_memory_padding;
+    return extra_memory_padding.load() != nullptr;
 }
 }
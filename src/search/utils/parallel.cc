@@ -0,0 +1,27 @@
+#include "parallel.h"
+
+#include <cassert>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace utils {
+void run_in_parallel(int num_threads, const function<void(int)> &func) {
+    assert(num_threads >= 1);
+    if (num_threads == 1) {
+        func(0);
+        return;
+    }
+    vector<thread> threads;
+    threads.reserve(num_threads - 1);
+    for (int thread_id = 1; thread_id < num_threads; ++thread_id) {
+        threads.emplace_back(func, thread_id);
+    }
+    // Let the current thread do its share of the work.
+    func(0);
+    for (thread &t : threads) {
+        t.join();
+    }
+}
+}
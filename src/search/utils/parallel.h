@@ -0,0 +1,19 @@
+#ifndef UTILS_PARALLEL_H
+#define UTILS_PARALLEL_H
+
+#include <functional>
+
+namespace utils {
+/*
+  Call func(thread_id) for all thread IDs in [0, num_threads) concurrently and
+  return once all calls have finished. For num_threads = 1, func is called in
+  the current thread.
+
+  Note that our timers measure the CPU time of the whole process. When
+  num_threads threads are busy, timers therefore run up to num_threads times
+  faster than the wall clock.
+*/
+extern void run_in_parallel(int num_threads, const std::function<void(int)> &func);
+}
+
+#endif
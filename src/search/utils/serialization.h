@@ -0,0 +1,84 @@
+#ifndef UTILS_SERIALIZATION_H
+#define UTILS_SERIALIZATION_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace utils {
+/*
+  Minimal helpers for writing and reading binary data. The format uses the
+  native byte order and type sizes, so files should only be read on the
+  machine type that wrote them.
+
+  Reading functions do not report errors themselves. Callers should check the
+  stream state (e.g., with is.good()) after reading a group of values.
+*/
+template<typename T>
+void write_binary(std::ostream &os, const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T>
+T read_binary(std::istream &is) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value{};
+    is.read(reinterpret_cast<char *>(&value), sizeof(T));
+    return value;
+}
+
+template<typename T>
+void write_binary_vector(std::ostream &os, const std::vector<T> &vec) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    write_binary<std::uint64_t>(os, vec.size());
+    os.write(reinterpret_cast<const char *>(vec.data()), vec.size() * sizeof(T));
+}
+
+// The placeholder is only needed for types without a default constructor.
+template<typename T>
+std::vector<T> read_binary_vector(std::istream &is, const T &placeholder = T()) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::uint64_t size = read_binary<std::uint64_t>(is);
+    std::vector<T> vec;
+    if (!is) {
+        return vec;
+    }
+    // Guard against allocating huge vectors for corrupted input.
+    std::streampos pos = is.tellg();
+    is.seekg(0, std::ios::end);
+    std::streamoff remaining_bytes = is.tellg() - pos;
+    is.seekg(pos);
+    if (size > static_cast<std::uint64_t>(remaining_bytes) / sizeof(T)) {
+        is.setstate(std::ios::failbit);
+        return vec;
+    }
+    vec.resize(size, placeholder);
+    is.read(reinterpret_cast<char *>(vec.data()), size * sizeof(T));
+    return vec;
+}
+
+// std::vector<bool> is not contiguous, so we store one byte per entry.
+inline void write_binary_vector(std::ostream &os, const std::vector<bool> &vec) {
+    write_binary_vector(os, std::vector<std::uint8_t>(vec.begin(), vec.end()));
+}
+
+inline std::vector<bool> read_binary_bool_vector(std::istream &is) {
+    std::vector<std::uint8_t> bytes = read_binary_vector<std::uint8_t>(is);
+    return std::vector<bool>(bytes.begin(), bytes.end());
+}
+
+inline void write_binary_string(std::ostream &os, const std::string &str) {
+    write_binary_vector(os, std::vector<char>(str.begin(), str.end()));
+}
+
+inline std::string read_binary_string(std::istream &is) {
+    std::vector<char> chars = read_binary_vector<char>(is);
+    return std::string(chars.begin(), chars.end());
+}
+}
+
+#endif